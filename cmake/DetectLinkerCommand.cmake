@@ -0,0 +1,67 @@
+# Computes the command line the C compiler driver uses to link an executable
+# (the one printed by `cc -### probe.o -o probe`) so that peony can later run
+# the linker directly, without going through a shell nor a compiler driver.
+#
+# Defines PEONY_LINKER_COMMAND as a list of arguments where the input objects
+# are replaced by the placeholder `@objects@` and the output executable by
+# `@output@`. If the command can not be detected, the compiler driver itself
+# is used as the linker and PEONY_LINKER_DETECTED is false.
+
+set(_probe_object "${CMAKE_CURRENT_BINARY_DIR}/peony_link_probe.o")
+set(_probe_output "${CMAKE_CURRENT_BINARY_DIR}/peony_link_probe")
+
+set(PEONY_LINKER_COMMAND "${CMAKE_C_COMPILER}" "@objects@" "-o" "@output@")
+set(PEONY_LINKER_DETECTED FALSE)
+
+if(NOT MSVC)
+    execute_process(
+        COMMAND ${CMAKE_C_COMPILER} "-###" "${_probe_object}" -o "${_probe_output}"
+        OUTPUT_VARIABLE _probe_stdout
+        ERROR_VARIABLE _probe_stderr
+        RESULT_VARIABLE _probe_result
+    )
+
+    if(_probe_result EQUAL 0)
+        string(REPLACE "\n" ";" _probe_lines "${_probe_stdout}\n${_probe_stderr}")
+        foreach(_line IN LISTS _probe_lines)
+            # The linker invocation is the only line referencing the object.
+            if(NOT _line MATCHES "peony_link_probe\\.o" OR _line MATCHES "^COLLECT_")
+                continue()
+            endif()
+
+            separate_arguments(_args UNIX_COMMAND "${_line}")
+            set(_command)
+            set(_skip_next FALSE)
+            foreach(_arg IN LISTS _args)
+                if(_skip_next)
+                    set(_skip_next FALSE)
+                elseif(_arg STREQUAL "-plugin")
+                    # The LTO plugin is not needed as peony never gives GCC IR
+                    # to the linker, and its options reference temporary files.
+                    set(_skip_next TRUE)
+                elseif(_arg MATCHES "^-plugin-opt")
+                elseif(_arg STREQUAL _probe_object)
+                    list(APPEND _command "@objects@")
+                elseif(_arg STREQUAL _probe_output)
+                    list(APPEND _command "@output@")
+                else()
+                    list(APPEND _command "${_arg}")
+                endif()
+            endforeach()
+
+            set(PEONY_LINKER_COMMAND ${_command})
+            set(PEONY_LINKER_DETECTED TRUE)
+            break()
+        endforeach()
+    endif()
+endif()
+
+message(STATUS "Peony linker command: ${PEONY_LINKER_COMMAND}")
+
+# Formats the command as a C++ initializer list for linker_command.hxx.in.
+set(PEONY_LINKER_COMMAND_INIT "")
+foreach(_arg IN LISTS PEONY_LINKER_COMMAND)
+    string(REPLACE "\\" "\\\\" _arg "${_arg}")
+    string(REPLACE "\"" "\\\"" _arg "${_arg}")
+    string(APPEND PEONY_LINKER_COMMAND_INIT "\"${_arg}\", ")
+endforeach()
@@ -2,9 +2,9 @@
 #include "ast_printer.hxx"
 
 void
-PDecl::dump(PContext& p_ctx)
+PDecl::dump(PContext& p_ctx, FILE* p_output)
 {
-  PAstPrinter printer(p_ctx);
+  PAstPrinter printer(p_ctx, p_output);
   printer.visit(this);
 }
 
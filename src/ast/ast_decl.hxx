@@ -7,6 +7,8 @@
 #include "utils/array_view.hxx"
 #include "utils/source_location.hxx"
 
+#include <cstdio>
+
 class PAst;
 class PAstExpr;
 
@@ -54,7 +56,7 @@ public:
     return const_cast<PDecl*>(this)->as<T>();
   }
 
-  void dump(PContext& p_ctx);
+  void dump(PContext& p_ctx, FILE* p_output = stdout);
 
 protected:
   PDecl(PDeclKind p_kind, PType* p_type, PLocalizedIdentifierInfo p_name, PSourceRange p_src_range)
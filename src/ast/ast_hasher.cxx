@@ -0,0 +1,376 @@
+#include "ast_hasher.hxx"
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/SHA256.h>
+
+// Markers serialized in place of absent nodes and of already serialized
+// structures. They can not be confused with a node kind.
+#define P_HASH_NULL_MARKER (-1)
+#define P_HASH_BACKREF_MARKER (-2)
+
+PAstHasher::PAstHasher(PContext& p_ctx, PSourceFile* p_source_file)
+  : m_ctx(p_ctx)
+  , m_source_file(p_source_file)
+{
+}
+
+std::string
+PAstHasher::hash_function(const PFunctionDecl* p_decl)
+{
+  m_data.clear();
+  m_hashed_structs.clear();
+  visit(p_decl);
+
+  llvm::SHA256 hasher;
+  hasher.update(llvm::StringRef(m_data));
+  return llvm::toHex(hasher.final(), /* LowerCase= */ true);
+}
+
+void
+PAstHasher::visit_null_stmt()
+{
+  add(P_HASH_NULL_MARKER);
+}
+
+void
+PAstHasher::visit_compound_stmt(const PAstCompoundStmt* p_node)
+{
+  add_stmt_header(p_node);
+  add(p_node->stmts.size());
+  visit(p_node->stmts);
+}
+
+void
+PAstHasher::visit_let_stmt(const PAstLetStmt* p_node)
+{
+  add_stmt_header(p_node);
+  add(p_node->var_decls.size());
+  visit(p_node->var_decls);
+}
+
+void
+PAstHasher::visit_break_stmt(const PAstBreakStmt* p_node)
+{
+  add_stmt_header(p_node);
+}
+
+void
+PAstHasher::visit_continue_stmt(const PAstContinueStmt* p_node)
+{
+  add_stmt_header(p_node);
+}
+
+void
+PAstHasher::visit_return_stmt(const PAstReturnStmt* p_node)
+{
+  add_stmt_header(p_node);
+  visit(p_node->ret_expr);
+}
+
+void
+PAstHasher::visit_loop_stmt(const PAstLoopStmt* p_node)
+{
+  add_stmt_header(p_node);
+  visit(p_node->body_stmt);
+}
+
+void
+PAstHasher::visit_while_stmt(const PAstWhileStmt* p_node)
+{
+  add_stmt_header(p_node);
+  visit(p_node->cond_expr);
+  visit(p_node->body_stmt);
+}
+
+void
+PAstHasher::visit_if_stmt(const PAstIfStmt* p_node)
+{
+  add_stmt_header(p_node);
+  visit(p_node->cond_expr);
+  visit(p_node->then_stmt);
+  visit(p_node->else_stmt);
+}
+
+void
+PAstHasher::visit_assert_stmt(const PAstAssertStmt* p_node)
+{
+  add_stmt_header(p_node);
+  visit(p_node->cond_expr);
+}
+
+void
+PAstHasher::visit_bool_literal(const PAstBoolLiteral* p_node)
+{
+  add_expr_header(p_node);
+  add(p_node->value);
+}
+
+void
+PAstHasher::visit_int_literal(const PAstIntLiteral* p_node)
+{
+  add_expr_header(p_node);
+  add(p_node->value);
+}
+
+void
+PAstHasher::visit_float_literal(const PAstFloatLiteral* p_node)
+{
+  add_expr_header(p_node);
+  add(p_node->value);
+}
+
+void
+PAstHasher::visit_paren_expr(const PAstParenExpr* p_node)
+{
+  add_expr_header(p_node);
+  visit(p_node->sub_expr);
+}
+
+void
+PAstHasher::visit_decl_ref_expr(const PAstDeclRefExpr* p_node)
+{
+  add_expr_header(p_node);
+  add_decl_ref(p_node->decl);
+}
+
+void
+PAstHasher::visit_unary_expr(const PAstUnaryExpr* p_node)
+{
+  add_expr_header(p_node);
+  add(p_node->opcode);
+  visit(p_node->sub_expr);
+}
+
+void
+PAstHasher::visit_binary_expr(const PAstBinaryExpr* p_node)
+{
+  add_expr_header(p_node);
+  add(p_node->opcode);
+  visit(p_node->lhs);
+  visit(p_node->rhs);
+}
+
+void
+PAstHasher::visit_member_expr(const PAstMemberExpr* p_node)
+{
+  add_expr_header(p_node);
+  visit(p_node->base_expr);
+  add(p_node->member->get_index_in_parent_fields());
+}
+
+void
+PAstHasher::visit_call_expr(const PAstCallExpr* p_node)
+{
+  add_expr_header(p_node);
+  visit(p_node->callee);
+  add(p_node->args.size());
+  visit(p_node->args);
+}
+
+void
+PAstHasher::visit_cast_expr(const PAstCastExpr* p_node)
+{
+  add_expr_header(p_node);
+  add(p_node->cast_kind);
+  visit(p_node->target_ty);
+  visit(p_node->sub_expr);
+}
+
+void
+PAstHasher::visit_struct_expr(const PAstStructExpr* p_node)
+{
+  add_expr_header(p_node);
+  add(p_node->get_field_count());
+  for (auto* field : p_node->get_fields()) {
+    add(field->get_field_decl()->get_index_in_parent_fields());
+    visit(field->get_expr());
+  }
+}
+
+void
+PAstHasher::visit_l2rvalue_expr(const PAstL2RValueExpr* p_node)
+{
+  add_expr_header(p_node);
+  visit(p_node->sub_expr);
+}
+
+void
+PAstHasher::visit_null_decl()
+{
+  add(P_HASH_NULL_MARKER);
+}
+
+void
+PAstHasher::visit_func_decl(const PFunctionDecl* p_node)
+{
+  add_decl_ref(p_node);
+  add(p_node->params.size());
+  visit(p_node->params);
+  visit(p_node->get_body());
+}
+
+void
+PAstHasher::visit_param_decl(const PParamDecl* p_node)
+{
+  add(p_node->get_kind());
+  add_name(p_node->get_name());
+  add_location(p_node->source_range.begin);
+  visit(p_node->get_type());
+}
+
+void
+PAstHasher::visit_var_decl(const PVarDecl* p_node)
+{
+  add(p_node->get_kind());
+  add_name(p_node->get_name());
+  add_location(p_node->source_range.begin);
+  visit(p_node->get_type());
+  visit(p_node->init_expr);
+}
+
+void
+PAstHasher::visit_null_ty()
+{
+  add(P_HASH_NULL_MARKER);
+}
+
+void
+PAstHasher::visit_builtin_ty(const PType* p_node)
+{
+  add(p_node->get_kind());
+}
+
+void
+PAstHasher::visit_paren_ty(const PParenType* p_node)
+{
+  add(p_node->get_kind());
+  visit(p_node->get_sub_type());
+}
+
+void
+PAstHasher::visit_func_ty(const PFunctionType* p_node)
+{
+  add(p_node->get_kind());
+  visit(p_node->get_ret_ty());
+  add(p_node->get_param_count());
+  for (auto* param_ty : p_node->get_params())
+    visit(param_ty);
+}
+
+void
+PAstHasher::visit_pointer_ty(const PPointerType* p_node)
+{
+  add(p_node->get_kind());
+  visit(p_node->get_element_ty());
+}
+
+void
+PAstHasher::visit_array_ty(const PArrayType* p_node)
+{
+  add(p_node->get_kind());
+  add(p_node->get_num_elements());
+  visit(p_node->get_element_ty());
+}
+
+void
+PAstHasher::visit_tag_ty(const PTagType* p_node)
+{
+  add(p_node->get_kind());
+
+  auto* decl = p_node->get_decl();
+  add(decl->get_kind());
+  add_name(decl->get_name());
+
+  // Structures may reference themselves (through pointers).
+  if (!m_hashed_structs.insert(decl).second) {
+    add(P_HASH_BACKREF_MARKER);
+    return;
+  }
+
+  assert(decl->get_kind() == P_DK_STRUCT);
+  auto fields = decl->as<PStructDecl>()->get_fields();
+  add(fields.size());
+  for (auto* field : fields) {
+    add_name(field->get_name());
+    visit(field->get_type());
+  }
+}
+
+void
+PAstHasher::visit_unknown_ty(const PUnknownType* p_node)
+{
+  add(p_node->get_kind());
+  add_name(p_node->get_name());
+}
+
+void
+PAstHasher::add_bytes(const void* p_data, size_t p_size)
+{
+  m_data.append(static_cast<const char*>(p_data), p_size);
+}
+
+void
+PAstHasher::add_string(std::string_view p_str)
+{
+  // Prefixed by its size so that consecutive strings can not be confused.
+  add(p_str.size());
+  add_bytes(p_str.data(), p_str.size());
+}
+
+void
+PAstHasher::add_name(PIdentifierInfo* p_name)
+{
+  if (p_name == nullptr)
+    add(P_HASH_NULL_MARKER);
+  else
+    add_string(p_name->get_spelling());
+}
+
+void
+PAstHasher::add_location(PSourceLocation p_src_loc)
+{
+  if (m_source_file == nullptr)
+    return;
+
+  // Only the line and column are used by the debug information, the offset
+  // changes with any edit before the node.
+  uint32_t lineno, colno;
+  p_source_location_get_lineno_and_colno(m_source_file, p_src_loc, &lineno, &colno);
+  add(lineno);
+  add(colno);
+}
+
+void
+PAstHasher::add_stmt_header(const PAst* p_node)
+{
+  add(p_node->get_kind());
+  add_location(p_node->get_source_range().begin);
+}
+
+void
+PAstHasher::add_expr_header(const PAstExpr* p_node)
+{
+  add_stmt_header(p_node);
+  visit(p_node->get_type(m_ctx));
+}
+
+void
+PAstHasher::add_decl_ref(const PDecl* p_decl)
+{
+  add(p_decl->get_kind());
+  add_name(p_decl->get_name());
+
+  if (p_decl->get_kind() == P_DK_FUNCTION) {
+    // Functions are referenced by their symbol name, only their signature
+    // matters to the caller.
+    auto* func_decl = p_decl->as<PFunctionDecl>();
+    visit(func_decl->get_type());
+    add(func_decl->is_extern());
+    add(func_decl->has_abi());
+    add_string(func_decl->get_abi());
+  } else {
+    // Local variables and parameters are identified by their location, they
+    // are hashed themselves where declared.
+    add_location(p_decl->source_range.begin);
+  }
+}
@@ -0,0 +1,89 @@
+#ifndef PEONY_AST_HASHER_HXX
+#define PEONY_AST_HASHER_HXX
+
+#include "ast_visitor.hxx"
+#include "utils/hash_map.hxx"
+
+#include <string>
+#include <string_view>
+
+/// Computes a structural hash of function declarations, used to reuse the code
+/// generated for the functions that did not change (-fincremental-codegen).
+///
+/// The hash covers everything the code generated for a function depends on:
+/// its signature, its body (including the line and column of each node which
+/// are part of the debug information), the types it uses and the signatures of
+/// the functions it references. It does not depend on the body of the other
+/// functions, as each function is compiled separately.
+class PAstHasher : public PAstConstVisitor<PAstHasher>
+{
+public:
+  PAstHasher(PContext& p_ctx, PSourceFile* p_source_file);
+
+  /// Returns the hash of p_decl as a hexadecimal string.
+  [[nodiscard]] std::string hash_function(const PFunctionDecl* p_decl);
+
+  void visit_null_stmt();
+  void visit_compound_stmt(const PAstCompoundStmt* p_node);
+  void visit_let_stmt(const PAstLetStmt* p_node);
+  void visit_break_stmt(const PAstBreakStmt* p_node);
+  void visit_continue_stmt(const PAstContinueStmt* p_node);
+  void visit_return_stmt(const PAstReturnStmt* p_node);
+  void visit_loop_stmt(const PAstLoopStmt* p_node);
+  void visit_while_stmt(const PAstWhileStmt* p_node);
+  void visit_if_stmt(const PAstIfStmt* p_node);
+  void visit_assert_stmt(const PAstAssertStmt* p_node);
+
+  void visit_bool_literal(const PAstBoolLiteral* p_node);
+  void visit_int_literal(const PAstIntLiteral* p_node);
+  void visit_float_literal(const PAstFloatLiteral* p_node);
+  void visit_paren_expr(const PAstParenExpr* p_node);
+  void visit_decl_ref_expr(const PAstDeclRefExpr* p_node);
+  void visit_unary_expr(const PAstUnaryExpr* p_node);
+  void visit_binary_expr(const PAstBinaryExpr* p_node);
+  void visit_member_expr(const PAstMemberExpr* p_node);
+  void visit_call_expr(const PAstCallExpr* p_node);
+  void visit_cast_expr(const PAstCastExpr* p_node);
+  void visit_struct_expr(const PAstStructExpr* p_node);
+  void visit_l2rvalue_expr(const PAstL2RValueExpr* p_node);
+
+  void visit_null_decl();
+  void visit_func_decl(const PFunctionDecl* p_node);
+  void visit_param_decl(const PParamDecl* p_node);
+  void visit_var_decl(const PVarDecl* p_node);
+
+  void visit_null_ty();
+  void visit_builtin_ty(const PType* p_node);
+  void visit_paren_ty(const PParenType* p_node);
+  void visit_func_ty(const PFunctionType* p_node);
+  void visit_pointer_ty(const PPointerType* p_node);
+  void visit_array_ty(const PArrayType* p_node);
+  void visit_tag_ty(const PTagType* p_node);
+  void visit_unknown_ty(const PUnknownType* p_node);
+
+private:
+  void add_bytes(const void* p_data, size_t p_size);
+  template<class T>
+  void add(T p_value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    add_bytes(&p_value, sizeof(T));
+  }
+  void add_string(std::string_view p_str);
+  void add_name(PIdentifierInfo* p_name);
+  void add_location(PSourceLocation p_src_loc);
+  void add_stmt_header(const PAst* p_node);
+  void add_expr_header(const PAstExpr* p_node);
+  /// Adds a declaration referenced from the function body. For functions, only
+  /// their signature is hashed.
+  void add_decl_ref(const PDecl* p_decl);
+
+  PContext& m_ctx;
+  PSourceFile* m_source_file;
+  // The serialized structure, hashed once the whole function is visited.
+  std::string m_data;
+  // The structures already serialized, to handle recursive types.
+  PHashSet<const PDecl*> m_hashed_structs;
+};
+
+#endif // PEONY_AST_HASHER_HXX
@@ -0,0 +1,71 @@
+#include "../parser.hxx"
+#include "ast_hasher.hxx"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+/// Parses p_input and returns the hash of each of its functions by name.
+static std::map<std::string, std::string>
+hash_functions(const char* p_input)
+{
+  PContext context;
+  PIdentifierTable identifier_table;
+
+  PSourceFile source_file("<test-input>", p_input);
+  PLexer lexer;
+  lexer.identifier_table = &identifier_table;
+  lexer.set_source_file(&source_file);
+
+  // The diagnostic counts are cumulative, they include the other tests ones.
+  const int error_count = g_diag_context.diagnostic_count[P_DIAG_ERROR];
+  PParser parser(context, lexer);
+  PAstTranslationUnit* ast = parser.parse();
+  EXPECT_EQ(g_diag_context.diagnostic_count[P_DIAG_ERROR], error_count);
+
+  std::map<std::string, std::string> hashes;
+  PAstHasher hasher(context, &source_file);
+  for (auto* decl : ast->decls) {
+    if (decl->get_kind() == P_DK_FUNCTION)
+      hashes[std::string(decl->get_name()->get_spelling())] = hasher.hash_function(decl->as<PFunctionDecl>());
+  }
+
+  return hashes;
+}
+
+TEST(AstHasher, same_source)
+{
+  const char* input = "fn g(x: i32) -> i32 { return x * 2; }\n"
+                      "fn f() -> i32 { let x = 5; return g(x) + 1; }\n";
+  auto hashes = hash_functions(input);
+  EXPECT_EQ(hash_functions(input), hashes);
+  EXPECT_NE(hashes["f"], hashes["g"]);
+}
+
+TEST(AstHasher, callee_body)
+{
+  // The hash of the caller does not depend on the body of the callee.
+  auto old_hashes = hash_functions("fn g(x: i32) -> i32 { return x * 2; }\n"
+                                   "fn f() -> i32 { return g(1); }\n");
+  auto new_hashes = hash_functions("fn g(x: i32) -> i32 { return x * 3; }\n"
+                                   "fn f() -> i32 { return g(1); }\n");
+  EXPECT_EQ(old_hashes["f"], new_hashes["f"]);
+  EXPECT_NE(old_hashes["g"], new_hashes["g"]);
+}
+
+TEST(AstHasher, callee_signature)
+{
+  auto old_hashes = hash_functions("fn g() -> bool { return true; }\n"
+                                   "fn f() { g(); }\n");
+  auto new_hashes = hash_functions("fn g() -> i32 { return 1; }\n"
+                                   "fn f() { g(); }\n");
+  EXPECT_NE(old_hashes["f"], new_hashes["f"]);
+}
+
+TEST(AstHasher, locations)
+{
+  // The lines are part of the debug information.
+  auto old_hashes = hash_functions("fn f() -> i32 { return 0; }\n");
+  auto new_hashes = hash_functions("\nfn f() -> i32 { return 0; }\n");
+  EXPECT_NE(old_hashes["f"], new_hashes["f"]);
+}
@@ -2,8 +2,8 @@
 #include "ast_printer.hxx"
 
 void
-PAst::dump(PContext& p_ctx)
+PAst::dump(PContext& p_ctx, FILE* p_output)
 {
-  PAstPrinter printer(p_ctx);
+  PAstPrinter printer(p_ctx, p_output);
   printer.visit(this);
 }
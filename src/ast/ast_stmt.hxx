@@ -8,6 +8,7 @@
 #include "utils/source_location.hxx"
 
 #include <cassert>
+#include <cstdio>
 
 class PDecl;
 class PVarDecl;
@@ -64,7 +65,7 @@ public:
     return const_cast<PAst*>(this)->as<T>();
   }
 
-  void dump(PContext& p_ctx);
+  void dump(PContext& p_ctx, FILE* p_output = stdout);
 
 protected:
   PAst(PStmtKind p_kind, PSourceRange p_src_range)
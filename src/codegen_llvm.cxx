@@ -1,13 +1,24 @@
 #include "codegen_llvm.hxx"
 
+#include "options.hxx"
+#include "utils/hash_map.hxx"
+#include "utils/mem_report.hxx"
+#include "utils/time_report.hxx"
+
 #include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/Analysis/LoopAnalysisManager.h>
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/LTO/Config.h>
+#include <llvm/MC/SubtargetFeature.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Host.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
@@ -23,6 +34,48 @@ to_str_ref(PIdentifierInfo* p_name)
   return { spelling.data(), spelling.size() };
 }
 
+static llvm::CodeGenOpt::Level
+to_llvm_codegen_opt_level(POptimizationLevel p_level)
+{
+  switch (p_level) {
+    case P_OPT_O0:
+      return llvm::CodeGenOpt::None;
+    case P_OPT_O:
+    case P_OPT_O1:
+      return llvm::CodeGenOpt::Less;
+    case P_OPT_O3:
+      return llvm::CodeGenOpt::Aggressive;
+    case P_OPT_O2:
+    case P_OPT_Os:
+    case P_OPT_Oz:
+    default:
+      return llvm::CodeGenOpt::Default;
+  }
+}
+
+static llvm::OptimizationLevel
+to_llvm_opt_level(POptimizationLevel p_level)
+{
+  switch (p_level) {
+    case P_OPT_O0:
+      return llvm::OptimizationLevel::O0;
+    case P_OPT_O:
+    case P_OPT_O1:
+      return llvm::OptimizationLevel::O1;
+    case P_OPT_O2:
+      return llvm::OptimizationLevel::O2;
+    case P_OPT_O3:
+      return llvm::OptimizationLevel::O3;
+    case P_OPT_Os:
+      return llvm::OptimizationLevel::Os;
+    case P_OPT_Oz:
+      return llvm::OptimizationLevel::Oz;
+    default:
+      assert(false && "unreachable");
+      return llvm::OptimizationLevel::O0;
+  }
+}
+
 struct PCodeGenLLVM::D
 {
   PContext& ctx;
@@ -33,13 +86,15 @@ struct PCodeGenLLVM::D
   std::unique_ptr<llvm::IRBuilder<>> builder;
   std::unique_ptr<llvm::DIBuilder> debug_builder;
 
-  std::unordered_map<PType*, llvm::Type*> types_cache;
-  std::unordered_map<PType*, llvm::DIType*> debug_types_cache;
-  std::unordered_map<const PDecl*, llvm::Value*> decls;
+  PHashMap<PType*, llvm::Type*> types_cache;
+  PHashMap<PType*, llvm::DIType*> debug_types_cache;
+  PHashMap<const PDecl*, llvm::Value*> decls;
 
   llvm::DICompileUnit* debug_compile_unit;
   llvm::DIFile* debug_file;
   PSourceFile* current_file;
+  // If not null, the only function whose body is generated.
+  const PFunctionDecl* only_function = nullptr;
   std::stack<llvm::DIScope*> lexical_blocks;
 
   struct LoopInfoEntry
@@ -171,12 +226,11 @@ struct PCodeGenLLVM::D
     // Unlike to_llvm_ty() we do not use canonical type for lookup because
     // for debugging we really want the type as written by the user.
 
-    const auto it = debug_types_cache.find(p_type);
-    if (it != debug_types_cache.end())
-      return it->second;
+    if (auto* debug_type = debug_types_cache.find(p_type))
+      return *debug_type;
 
     auto* llvm_type = to_debug_ty_impl(p_type);
-    debug_types_cache.insert({ p_type, llvm_type });
+    debug_types_cache.insert(p_type, llvm_type);
     return llvm_type;
   }
 
@@ -280,13 +334,12 @@ struct PCodeGenLLVM::D
 
     p_type = p_type->get_canonical_ty();
 
-    const auto it = types_cache.find(p_type);
-    if (it != types_cache.end())
-      return it->second;
+    if (auto* type = types_cache.find(p_type))
+      return *type;
 
     auto* llvm_type = to_llvm_ty_impl(p_type);
     assert(llvm_type != nullptr);
-    types_cache.insert({ p_type, llvm_type });
+    types_cache.insert(p_type, llvm_type);
     return llvm_type;
   }
 
@@ -382,6 +435,27 @@ PCodeGenLLVM::PCodeGenLLVM(PContext& p_ctx)
 
 PCodeGenLLVM::~PCodeGenLLVM() = default;
 
+// The CPU and the CPU features targeted by the generated code.
+static const char* const g_target_cpu = "generic";
+static const char* const g_target_features = "";
+
+std::string
+PCodeGenLLVM::get_target_id()
+{
+  return llvm::sys::getDefaultTargetTriple() + ";" + g_target_cpu + ";" + g_target_features;
+}
+
+void
+PCodeGenLLVM::init_lto_config(llvm::lto::Config& p_config)
+{
+  p_config.CPU = g_target_cpu;
+  p_config.MAttrs = llvm::SubtargetFeatures(g_target_features).getFeatures();
+  // Same as the translation units compiled without LTO, see codegen().
+  p_config.RelocModel = llvm::None;
+  p_config.OptLevel = to_llvm_opt_level(g_options.opt_optimization_level).getSpeedupLevel();
+  p_config.CGOptLevel = to_llvm_codegen_opt_level(g_options.opt_optimization_level);
+}
+
 bool
 PCodeGenLLVM::codegen(PAstTranslationUnit* p_ast)
 {
@@ -390,6 +464,12 @@ PCodeGenLLVM::codegen(PAstTranslationUnit* p_ast)
   m_d->debug_compile_unit =
     m_d->debug_builder->createCompileUnit(llvm::dwarf::DW_LANG_C, m_d->debug_file, "Peony Compiler", true, "", 0);
 
+  // ThinLTO also identifies the local symbols by the source file name.
+  m_d->llvm_module->setSourceFileName(p_ast->p_src_file->get_filename());
+  // Otherwise, the debug information is stripped when the bitcode is loaded
+  // back for link-time optimization.
+  m_d->llvm_module->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+
   auto target_triple = llvm::sys::getDefaultTargetTriple();
   m_d->llvm_module->setTargetTriple(target_triple);
 
@@ -404,37 +484,83 @@ PCodeGenLLVM::codegen(PAstTranslationUnit* p_ast)
     return false;
   }
 
-  auto cpu = "generic";
-  auto features = "";
-
   llvm::TargetOptions opt;
   auto rm = llvm::Optional<llvm::Reloc::Model>();
-  m_d->target_machine = target->createTargetMachine(target_triple, cpu, features, opt, rm);
+  auto opt_level = to_llvm_codegen_opt_level(g_options.opt_optimization_level);
+  m_d->target_machine =
+    target->createTargetMachine(target_triple, g_target_cpu, g_target_features, opt, rm, llvm::None, opt_level);
 
   m_d->llvm_module->setDataLayout(m_d->target_machine->createDataLayout());
   m_d->llvm_module->setTargetTriple(target_triple);
 
   visit(p_ast);
-  m_d->llvm_module->dump();
   m_d->debug_builder->finalize();
   assert(!llvm::verifyModule(*m_d->llvm_module, &llvm::errs()));
   return true;
 }
 
+/// Returns the name of the IR unit (module, function, loop, etc.) a pass is
+/// run on, as given to the pass instrumentation callbacks.
+static std::string
+get_ir_unit_name(const llvm::Any& p_ir)
+{
+  if (llvm::any_isa<const llvm::Module*>(p_ir))
+    return llvm::any_cast<const llvm::Module*>(p_ir)->getName().str();
+  if (llvm::any_isa<const llvm::Function*>(p_ir))
+    return llvm::any_cast<const llvm::Function*>(p_ir)->getName().str();
+  if (llvm::any_isa<const llvm::LazyCallGraph::SCC*>(p_ir))
+    return llvm::any_cast<const llvm::LazyCallGraph::SCC*>(p_ir)->getName();
+  if (llvm::any_isa<const llvm::Loop*>(p_ir))
+    return llvm::any_cast<const llvm::Loop*>(p_ir)->getName().str();
+  return {};
+}
+
+bool
+PCodeGenLLVM::codegen_function(PAstTranslationUnit* p_ast, const PFunctionDecl* p_func)
+{
+  m_d->only_function = p_func;
+  return codegen(p_ast);
+}
+
 void
-PCodeGenLLVM::optimize()
+PCodeGenLLVM::optimize(PLtoMode p_lto_mode)
 {
+  const auto opt_level = to_llvm_opt_level(g_options.opt_optimization_level);
+  // At -O0 we do not run any pass, the IR is already in the expected form.
+  if (opt_level == llvm::OptimizationLevel::O0)
+    return;
+
   // Create the analysis managers.
   llvm::LoopAnalysisManager lam;
   llvm::FunctionAnalysisManager fam;
   llvm::CGSCCAnalysisManager cgam;
   llvm::ModuleAnalysisManager mam;
 
-  // Create the new pass manager builder.
-  // Take a look at the PassBuilder constructor parameters for more
-  // customization, e.g. specifying a TargetMachine or various debugging
-  // options.
-  llvm::PassBuilder pb;
+  // Time each pass for -ftime-report and -ftime-trace. Passes are nested (pass
+  // managers and adaptors run other passes), hence the stack of regions.
+  std::vector<std::unique_ptr<PTimeRegion>> pass_regions;
+  llvm::PassInstrumentationCallbacks pic;
+  if (g_options.opt_time_report || time_trace_enabled()) {
+    auto start_region = [&pass_regions](llvm::StringRef p_pass_id, llvm::Any p_ir) {
+      std::string_view name(p_pass_id.data(), p_pass_id.size());
+      auto& region = pass_regions.emplace_back(std::make_unique<PTimeRegion>(P_TIME_GROUP_LLVM_PASSES, name));
+      if (time_trace_enabled())
+        region->set_trace_detail(get_ir_unit_name(p_ir));
+    };
+    auto stop_region = [&pass_regions]() { pass_regions.pop_back(); };
+
+    pic.registerBeforeNonSkippedPassCallback(start_region);
+    pic.registerAfterPassCallback(
+      [stop_region](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses&) { stop_region(); });
+    pic.registerAfterPassInvalidatedCallback(
+      [stop_region](llvm::StringRef, const llvm::PreservedAnalyses&) { stop_region(); });
+    pic.registerBeforeAnalysisCallback(start_region);
+    pic.registerAfterAnalysisCallback([stop_region](llvm::StringRef, llvm::Any) { stop_region(); });
+  }
+
+  // Create the new pass manager builder. Giving it the target machine allows
+  // the passes to use the target cost models (inlining, vectorization, etc.).
+  llvm::PassBuilder pb(m_d->target_machine, llvm::PipelineTuningOptions(), llvm::None, &pic);
 
   // Register all the basic analyses with the managers.
   pb.registerModuleAnalyses(mam);
@@ -443,22 +569,104 @@ PCodeGenLLVM::optimize()
   pb.registerLoopAnalyses(lam);
   pb.crossRegisterProxies(lam, fam, cgam, mam);
 
-  // Create the pass manager.
-  // This one corresponds to a typical -O2 optimization pipeline.
-  llvm::ModulePassManager mpm = pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+  // Create the pass manager corresponding to the requested optimization level.
+  llvm::ModulePassManager mpm;
+  switch (p_lto_mode) {
+    case P_LTO_FULL:
+      mpm = pb.buildLTOPreLinkDefaultPipeline(opt_level);
+      break;
+    case P_LTO_THIN:
+      mpm = pb.buildThinLTOPreLinkDefaultPipeline(opt_level);
+      break;
+    default:
+      mpm = pb.buildPerModuleDefaultPipeline(opt_level);
+      break;
+  }
 
   // Optimize the IR!
   mpm.run(*m_d->llvm_module, mam);
 }
 
+void
+PCodeGenLLVM::dump_llvm_ir(FILE* p_output)
+{
+  std::string buffer;
+  llvm::raw_string_ostream stream(buffer);
+  m_d->llvm_module->print(stream, nullptr);
+  stream.flush();
+  fwrite(buffer.data(), sizeof(char), buffer.size(), p_output);
+}
+
+void
+PCodeGenLLVM::report_module_size() const
+{
+  size_t function_count = 0;
+  size_t block_count = 0;
+  size_t instruction_count = 0;
+  for (const llvm::Function& function : *m_d->llvm_module) {
+    if (function.isDeclaration())
+      continue;
+
+    function_count += 1;
+    for (const llvm::BasicBlock& block : function) {
+      block_count += 1;
+      instruction_count += block.size();
+    }
+  }
+
+  mem_report_add(P_MEM_GROUP_LLVM_MODULE, "Functions", 0, function_count);
+  mem_report_add(P_MEM_GROUP_LLVM_MODULE, "Basic blocks", 0, block_count);
+  mem_report_add(P_MEM_GROUP_LLVM_MODULE, "Instructions", 0, instruction_count);
+  mem_report_add(P_MEM_GROUP_LLVM_MODULE, "Global variables", 0, m_d->llvm_module->global_size());
+}
+
+/// Closes p_stream and returns false if any write to it failed (e.g. disk full).
+static bool
+close_output_stream(llvm::raw_fd_ostream& p_stream)
+{
+  p_stream.close();
+  if (p_stream.has_error()) {
+    // Otherwise, the destructor of the stream aborts the program.
+    p_stream.clear_error();
+    return false;
+  }
+
+  return true;
+}
+
 bool
 PCodeGenLLVM::write_llvm_ir(const std::string& p_filename)
 {
   std::error_code ec;
-  llvm::raw_fd_stream stream(p_filename, ec);
-  assert(!ec);
+  llvm::raw_fd_ostream stream(p_filename, ec, llvm::sys::fs::OF_Text);
+  if (ec)
+    return false;
+
   m_d->llvm_module->print(stream, nullptr);
-  return true;
+  return close_output_stream(stream);
+}
+
+bool
+PCodeGenLLVM::write_llvm_bc(const std::string& p_filename)
+{
+  std::error_code ec;
+  llvm::raw_fd_ostream stream(p_filename, ec);
+  if (ec)
+    return false;
+
+  llvm::WriteBitcodeToFile(*m_d->llvm_module, stream);
+  return close_output_stream(stream);
+}
+
+bool
+PCodeGenLLVM::write_assembly_file(const std::string& p_filename)
+{
+  std::error_code ec;
+  llvm::raw_fd_ostream stream(p_filename, ec, llvm::sys::fs::OF_Text);
+  if (ec)
+    return false;
+
+  return emit_machine_code(stream, /* p_assembly= */ true) && close_output_stream(stream);
 }
 
 bool
@@ -466,15 +674,50 @@ PCodeGenLLVM::write_object_file(const std::string& p_filename)
 {
   std::error_code ec;
   llvm::raw_fd_ostream stream(p_filename, ec);
-  if (ec) {
-    llvm::errs() << "Could not open file: " << ec.message();
+  if (ec)
     return false;
+
+  return emit_machine_code(stream, /* p_assembly= */ false) && close_output_stream(stream);
+}
+
+bool
+PCodeGenLLVM::write_object_to_memory(std::string& p_buffer)
+{
+  llvm::SmallVector<char, 0> buffer;
+  llvm::raw_svector_ostream stream(buffer);
+  if (!emit_machine_code(stream, /* p_assembly= */ false))
+    return false;
+
+  p_buffer.assign(buffer.begin(), buffer.end());
+  return true;
+}
+
+void
+PCodeGenLLVM::write_lto_bitcode_to_memory(PLtoMode p_lto_mode, std::string& p_buffer)
+{
+  p_buffer.clear();
+  llvm::raw_string_ostream stream(p_buffer);
+
+  if (p_lto_mode == P_LTO_THIN) {
+    // The summary allows the thin link to decide which functions to import
+    // from the other modules without loading them.
+    llvm::ProfileSummaryInfo psi(*m_d->llvm_module);
+    auto index = llvm::buildModuleSummaryIndex(*m_d->llvm_module, nullptr, &psi);
+    llvm::WriteBitcodeToFile(*m_d->llvm_module, stream, /* ShouldPreserveUseListOrder= */ false, &index);
+  } else {
+    llvm::WriteBitcodeToFile(*m_d->llvm_module, stream);
   }
 
+  stream.flush();
+}
+
+bool
+PCodeGenLLVM::emit_machine_code(llvm::raw_pwrite_stream& p_stream, bool p_assembly)
+{
   llvm::legacy::PassManager pass;
-  auto file_type = llvm::CGFT_ObjectFile;
+  auto file_type = p_assembly ? llvm::CGFT_AssemblyFile : llvm::CGFT_ObjectFile;
 
-  if (m_d->target_machine->addPassesToEmitFile(pass, stream, nullptr, file_type)) {
+  if (m_d->target_machine->addPassesToEmitFile(pass, p_stream, nullptr, file_type)) {
     llvm::errs() << "TargetMachine can't emit a file of this type";
     return false;
   }
@@ -483,6 +726,17 @@ PCodeGenLLVM::write_object_file(const std::string& p_filename)
   return true;
 }
 
+void
+PCodeGenLLVM::release_module(std::unique_ptr<llvm::Module>& p_module, std::unique_ptr<llvm::LLVMContext>& p_llvm_ctx)
+{
+  // The builders reference the module and the context, destroy them first.
+  m_d->debug_builder.reset();
+  m_d->builder.reset();
+
+  p_module = std::move(m_d->llvm_module);
+  p_llvm_ctx = std::move(m_d->llvm_ctx);
+}
+
 void*
 PCodeGenLLVM::visit_translation_unit(const PAstTranslationUnit* p_node)
 {
@@ -787,9 +1041,9 @@ void*
 PCodeGenLLVM::visit_decl_ref_expr(const PAstDeclRefExpr* p_node)
 {
   m_d->emit_location(p_node->get_source_range().begin);
-  const auto it = m_d->decls.find(p_node->decl);
-  assert(it != m_d->decls.end());
-  return it->second;
+  auto* value = m_d->decls.find(p_node->decl);
+  assert(value != nullptr);
+  return *value;
 }
 
 void*
@@ -1156,6 +1410,9 @@ PCodeGenLLVM::visit_func_decl(const PFunctionDecl* p_node)
   if (!p_node->is_used() && p_node->is_extern() && !p_node->has_body())
     return nullptr;
 
+  PTimeTraceScope trace_scope("CodeGen Function");
+  trace_scope.set_detail(p_node->get_name()->get_spelling());
+
   auto* func_ty = m_d->to_llvm_ty(p_node->get_type());
   assert(func_ty->isFunctionTy());
   auto func_callee =
@@ -1188,10 +1445,13 @@ PCodeGenLLVM::visit_func_decl(const PFunctionDecl* p_node)
     }
   }
 
-  m_d->decls.insert({ p_node, func });
+  m_d->decls.insert(p_node, func);
+
+  // The other functions are compiled separately, only declare them.
+  bool generate_body = p_node->has_body() && (m_d->only_function == nullptr || m_d->only_function == p_node);
 
   // Generate debug info only for functions with a definition.
-  bool generate_debug_info = p_node->has_body();
+  bool generate_debug_info = generate_body;
 
   llvm::DISubprogram* debug_subprogram;
   if (generate_debug_info) {
@@ -1209,7 +1469,7 @@ PCodeGenLLVM::visit_func_decl(const PFunctionDecl* p_node)
   }
 
   // Function body generation.
-  if (p_node->has_body()) {
+  if (generate_body) {
     m_d->lexical_blocks.push(debug_subprogram);
     m_d->reset_location();
 
@@ -1222,7 +1482,7 @@ PCodeGenLLVM::visit_func_decl(const PFunctionDecl* p_node)
       auto* param_ty = m_d->to_llvm_ty(param->get_type());
       auto* param_addr = m_d->builder->CreateAlloca(param_ty);
       m_d->builder->CreateStore(func->getArg(i), param_addr);
-      m_d->decls.insert({ param, param_addr });
+      m_d->decls.insert(param, param_addr);
 
       // Generate debug info for the parameter
       auto* param_info = m_d->debug_builder->createParameterVariable(
@@ -1249,7 +1509,7 @@ PCodeGenLLVM::visit_var_decl(const PVarDecl* p_node)
   auto* type = m_d->to_llvm_ty(p_node->get_type());
   auto* ptr = m_d->insert_alloc_in_entry_bb(type);
 
-  m_d->decls.insert({ p_node, ptr });
+  m_d->decls.insert(p_node, ptr);
 
   auto* var_info = m_d->emit_var_info(p_node);
   m_d->debug_builder->insertDeclare(ptr,
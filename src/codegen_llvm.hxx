@@ -2,9 +2,17 @@
 #define PEONY_CODEGEN_LLVM_HXX
 
 #include "ast/ast_visitor.hxx"
+#include "options.hxx"
+
+#include <cstdio>
 
 namespace llvm {
+class LLVMContext;
 class Module;
+class raw_pwrite_stream;
+namespace lto {
+struct Config;
+}
 }
 
 /// LLVM code generator.
@@ -14,10 +22,44 @@ public:
   PCodeGenLLVM(PContext& p_ctx);
   ~PCodeGenLLVM();
 
+  /// Returns a string identifying the target of the generated code (the
+  /// target triple, CPU and CPU features).
+  static std::string get_target_id();
+  /// Sets the target and optimization options of the link-time optimizer
+  /// configuration p_config to the ones used by the code generator.
+  static void init_lto_config(llvm::lto::Config& p_config);
+
   bool codegen(PAstTranslationUnit* p_ast);
-  void optimize();
+  /// Same as codegen() but only generates the body of p_func. The other
+  /// functions of the translation unit are only declared so that they can be
+  /// called (see -fincremental-codegen).
+  bool codegen_function(PAstTranslationUnit* p_ast, const PFunctionDecl* p_func);
+  /// Runs the optimization pipeline. If p_lto_mode is not P_LTO_NONE, runs the
+  /// pre-link pipeline of the given link-time optimization mode instead: the
+  /// module is then optimized again with the other translation units.
+  void optimize(PLtoMode p_lto_mode = P_LTO_NONE);
+  /// Prints the LLVM IR of the module to p_output.
+  void dump_llvm_ir(FILE* p_output = stderr);
+  /// Adds the count of functions, basic blocks and instructions of the module
+  /// to the memory report (-fmem-report).
+  void report_module_size() const;
+
+  // The following functions write the module in the given format. They return
+  // false if the file can not be opened or written.
   bool write_llvm_ir(const std::string& p_filename);
+  bool write_llvm_bc(const std::string& p_filename);
+  bool write_assembly_file(const std::string& p_filename);
   bool write_object_file(const std::string& p_filename);
+  /// Same as write_object_file() but stores the object file into p_buffer.
+  bool write_object_to_memory(std::string& p_buffer);
+  /// Writes the module as bitcode into p_buffer for the link-time optimizer.
+  /// For ThinLTO, the bitcode includes the summary of the module.
+  void write_lto_bitcode_to_memory(PLtoMode p_lto_mode, std::string& p_buffer);
+
+  /// Releases the ownership of the generated module and its LLVM context (for
+  /// example to give them to the JIT). The code generator can not be used
+  /// anymore after this call.
+  void release_module(std::unique_ptr<llvm::Module>& p_module, std::unique_ptr<llvm::LLVMContext>& p_llvm_ctx);
 
   // Statements:
   void* visit_translation_unit(const PAstTranslationUnit* p_node);
@@ -50,6 +92,9 @@ public:
   void* visit_var_decl(const PVarDecl* p_node);
 
 private:
+  /// Emits the module as an object file or assembly (if p_assembly is true).
+  bool emit_machine_code(llvm::raw_pwrite_stream& p_stream, bool p_assembly);
+
   /// Emits code to implement the lazy binary operators '&&' and '||' (depending
   /// on the parameter p_is_and).
   void* emit_log_and(PAstExpr* p_lhs, PAstExpr* p_rhs, bool p_is_and);
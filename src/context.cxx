@@ -1,13 +1,27 @@
 #include "context.hxx"
-#include "ast/ast_decl.hxx"
+#include "ast/ast.hxx"
+#include "scope.hxx"
+#include "utils/mem_report.hxx"
 
 #include <cassert>
+#include <iterator>
 
-PContext&
-PContext::get_global()
+static_assert(P_SK_L2RVALUE_EXPR < PContextMemoryUsage::MAX_STMT_KIND_COUNT);
+static_assert(P_DK_STRUCT < PContextMemoryUsage::MAX_DECL_KIND_COUNT);
+
+std::string_view
+PContext::intern_string(std::string_view p_string)
 {
-  static PContext g_instance;
-  return g_instance;
+  const auto result = m_strings.lazy_emplace(p_string, p_hash_string(p_string), [&]() {
+    m_memory_usage.strings.bytes += p_string.size() + 1;
+    m_memory_usage.strings.count += 1;
+    char* copy = alloc_object<char>(p_string.size() + 1);
+    std::copy(p_string.begin(), p_string.end(), copy);
+    copy[p_string.size()] = '\0';
+    return std::string_view(copy, p_string.size());
+  });
+
+  return *result.first;
 }
 
 PParenType*
@@ -39,15 +53,13 @@ PContext::get_function_ty(PType* p_ret_ty, PArrayView<PType*> p_params)
   assert(p_ret_ty != nullptr);
 
   // If the type already exists return it.
-  const auto key = FuncTyKey{ p_ret_ty, p_params };
-  const auto it = m_func_tys.find(key);
-  if (it != m_func_tys.end())
-    return it->second;
+  if (auto* type = m_func_tys.find(FuncTyKey{ p_ret_ty, p_params }))
+    return *type;
 
-  auto** raw_params = m_allocator.alloc_object<PType*>(p_params.size());
+  auto** raw_params = alloc_object<PType*>(p_params.size());
   std::copy(p_params.begin(), p_params.end(), raw_params);
 
-  auto* type = m_allocator.alloc_object<PFunctionType>();
+  auto* type = alloc_object<PFunctionType>();
   new (type) PFunctionType(p_ret_ty, { raw_params, p_params.size() });
 
   if (!is_func_ty_canonical(p_ret_ty, p_params)) {
@@ -60,7 +72,7 @@ PContext::get_function_ty(PType* p_ret_ty, PArrayView<PType*> p_params)
     type->m_canonical_type = get_function_ty(can_ret_ty, can_args);
   }
 
-  m_func_tys.insert({ FuncTyKey{ type->get_ret_ty(), type->get_params() }, type });
+  m_func_tys.insert(FuncTyKey{ type->get_ret_ty(), type->get_params() }, type);
   return type;
 }
 
@@ -70,16 +82,15 @@ PContext::get_pointer_ty(PType* p_elt_ty)
   assert(p_elt_ty != nullptr);
 
   // If the type already exists return it.
-  const auto it = m_pointer_tys.find(p_elt_ty);
-  if (it != m_pointer_tys.end())
-    return it->second;
+  if (auto* type = m_pointer_tys.find(p_elt_ty))
+    return *type;
 
   auto* type = alloc_object<PPointerType>();
   new (type) PPointerType(p_elt_ty);
   if (!p_elt_ty->is_canonical_ty())
     type->m_canonical_type = get_pointer_ty(p_elt_ty->get_canonical_ty());
 
-  m_pointer_tys.insert({ p_elt_ty, type });
+  m_pointer_tys.insert(p_elt_ty, type);
   return type;
 }
 
@@ -89,16 +100,15 @@ PContext::get_array_ty(PType* p_elt_ty, size_t p_num_elements)
   assert(p_elt_ty != nullptr);
 
   // If the type already exists return it.
-  const auto it = m_array_tys.find(std::make_pair(p_elt_ty, p_num_elements));
-  if (it != m_array_tys.end())
-    return it->second;
+  if (auto* type = m_array_tys.find(ArrayTyKey{ p_elt_ty, p_num_elements }))
+    return *type;
 
   auto* type = alloc_object<PArrayType>();
   new (type) PArrayType(p_elt_ty, p_num_elements);
   if (!p_elt_ty->is_canonical_ty())
     type->m_canonical_type = get_array_ty(p_elt_ty->get_canonical_ty(), p_num_elements);
 
-  m_array_tys.insert({ { p_elt_ty, p_num_elements }, type });
+  m_array_tys.insert(ArrayTyKey{ p_elt_ty, p_num_elements }, type);
   return type;
 }
 
@@ -109,16 +119,15 @@ PContext::get_tag_ty(PDecl* p_decl)
   assert(p_decl->kind == P_DK_STRUCT);
 
   // If the type already exists return it.
-  const auto it = m_tag_tys.find(p_decl);
-  if (it != m_tag_tys.end())
-    return it->second;
+  if (auto* type = m_tag_tys.find(p_decl))
+    return *type;
 
   auto* type = alloc_object<PTagType>();
   new (type) PTagType(p_decl);
 
   // Tag types are always canonical.
 
-  m_tag_tys.insert({ p_decl, type });
+  m_tag_tys.insert(p_decl, type);
   return type;
 }
 
@@ -129,3 +138,97 @@ PContext::get_unknown_ty(PIdentifierInfo* p_name)
   new (type) PUnknownType(p_name);
   return type;
 }
+
+PContextMemoryUsage
+PContext::get_memory_usage() const
+{
+  PContextMemoryUsage usage = m_memory_usage;
+  usage.hash_table_bytes = m_strings.get_memory_usage() + m_pointer_tys.get_memory_usage() +
+                           m_tag_tys.get_memory_usage() + m_func_tys.get_memory_usage() +
+                           m_array_tys.get_memory_usage();
+
+  size_t recorded_bytes = usage.symbols.bytes + usage.strings.bytes + usage.hash_table_bytes;
+  for (const auto& entry : usage.stmts)
+    recorded_bytes += entry.bytes;
+  for (const auto& entry : usage.decls)
+    recorded_bytes += entry.bytes;
+  for (const auto& entry : usage.types)
+    recorded_bytes += entry.bytes;
+
+  // The hash tables replaced when growing are still in the allocator, but
+  // are not counted in hash_table_bytes.
+  const size_t allocated_bytes = m_allocator.get_allocated_bytes();
+  usage.other_bytes = (allocated_bytes > recorded_bytes) ? allocated_bytes - recorded_bytes : 0;
+  return usage;
+}
+
+// Indexed by PStmtKind.
+static const char* const g_stmt_kind_names[] = {
+  "P_SK_TRANSLATION_UNIT",
+  "P_SK_COMPOUND_STMT",
+  "P_SK_LET_STMT",
+  "P_SK_BREAK_STMT",
+  "P_SK_CONTINUE_STMT",
+  "P_SK_RETURN_STMT",
+  "P_SK_LOOP_STMT",
+  "P_SK_WHILE_STMT",
+  "P_SK_IF_STMT",
+  "P_SK_ASSERT_STMT",
+  "P_SK_BOOL_LITERAL",
+  "P_SK_INT_LITERAL",
+  "P_SK_FLOAT_LITERAL",
+  "P_SK_PAREN_EXPR",
+  "P_SK_DECL_REF_EXPR",
+  "P_SK_UNARY_EXPR",
+  "P_SK_BINARY_EXPR",
+  "P_SK_MEMBER_EXPR",
+  "P_SK_CALL_EXPR",
+  "P_SK_CAST_EXPR",
+  "P_SK_STRUCT_EXPR",
+  "P_SK_L2RVALUE_EXPR",
+};
+static_assert(std::size(g_stmt_kind_names) == P_SK_L2RVALUE_EXPR + 1);
+
+// Indexed by PDeclKind.
+static const char* const g_decl_kind_names[] = {
+  "P_DK_VAR",
+  "P_DK_PARAM",
+  "P_DK_FUNCTION",
+  "P_DK_STRUCT_FIELD",
+  "P_DK_STRUCT",
+};
+static_assert(std::size(g_decl_kind_names) == P_DK_STRUCT + 1);
+
+// Indexed by PTypeKind.
+static const char* const g_type_kind_names[] = {
+#define TYPE(p_kind) #p_kind,
+#include "type.def"
+};
+
+void
+PContext::report_memory_usage() const
+{
+  const PContextMemoryUsage usage = get_memory_usage();
+
+  const auto report = [](PMemGroup p_group, const char* p_name, const PMemRecord& p_entry) {
+    if (p_entry.count != 0)
+      mem_report_add(p_group, p_name, p_entry.bytes, p_entry.count);
+  };
+
+  for (size_t i = 0; i < std::size(g_stmt_kind_names); ++i)
+    report(P_MEM_GROUP_STMTS, g_stmt_kind_names[i], usage.stmts[i]);
+  for (size_t i = 0; i < std::size(g_decl_kind_names); ++i)
+    report(P_MEM_GROUP_DECLS, g_decl_kind_names[i], usage.decls[i]);
+  for (size_t i = 0; i < std::size(g_type_kind_names); ++i)
+    report(P_MEM_GROUP_TYPES, g_type_kind_names[i], usage.types[i]);
+
+  report(P_MEM_GROUP_OTHER, "Symbols", usage.symbols);
+  report(P_MEM_GROUP_OTHER, "Interned strings", usage.strings);
+  mem_report_add(P_MEM_GROUP_OTHER, "Type and string tables", usage.hash_table_bytes, 0);
+  mem_report_add(P_MEM_GROUP_OTHER, "Other context allocations", usage.other_bytes, 0);
+  // The alignment padding, the slab headers and the free space in the slabs.
+  mem_report_add(P_MEM_GROUP_OTHER,
+                 "Unused context slab bytes",
+                 m_allocator.get_reserved_bytes() - m_allocator.get_allocated_bytes(),
+                 0);
+}
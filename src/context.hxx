@@ -3,17 +3,52 @@
 
 #include "type.hxx"
 #include "utils/bump_allocator.hxx"
+#include "utils/hash_map.hxx"
+#include "utils/mem_report.hxx"
 
 #include <span>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 class PDecl;
+struct PSymbol;
 
+/// The bytes allocated in a context for each kind of object, see
+/// PContext::get_memory_usage().
+struct PContextMemoryUsage
+{
+  // The AST headers can not be included here, these bounds of the counts of
+  // PStmtKind and PDeclKind are checked in context.cxx.
+  static constexpr size_t MAX_STMT_KIND_COUNT = 32;
+  static constexpr size_t MAX_DECL_KIND_COUNT = 8;
+  static constexpr size_t TYPE_KIND_COUNT = 0
+#define TYPE(p_kind) +1
+#include "type.def"
+    ;
+
+  PMemRecord stmts[MAX_STMT_KIND_COUNT]; // indexed by PStmtKind
+  PMemRecord decls[MAX_DECL_KIND_COUNT]; // indexed by PDeclKind
+  PMemRecord types[TYPE_KIND_COUNT];     // indexed by PTypeKind
+  PMemRecord symbols;
+  PMemRecord strings; // see PContext::intern_string()
+  // The buckets of the hash tables of the context (types and strings).
+  size_t hash_table_bytes = 0;
+  // Everything else, for example the arrays of children of the AST nodes.
+  size_t other_bytes = 0;
+};
+
+/// The types, the AST and the interned strings of a translation unit. They
+/// are all allocated in the context and released together when it is
+/// destroyed, so each compilation should have its own context.
 class PContext
 {
 public:
-  static PContext& get_global();
+  PContext() = default;
+  explicit PContext(const PBumpAllocatorOptions& p_allocator_options)
+    : m_allocator(p_allocator_options)
+  {
+  }
 
   [[nodiscard]] PBumpAllocator& get_allocator() { return m_allocator; }
   [[nodiscard]] const PBumpAllocator& get_allocator() const { return m_allocator; }
@@ -23,14 +58,26 @@ public:
   template<class T>
   [[nodiscard]] T* alloc_object(size_t p_n = 1)
   {
+    record_allocation<T>(sizeof(T) * p_n);
     return m_allocator.alloc_object<T>(p_n);
   }
   template<class T, class... Args>
   [[nodiscard]] T* new_object(Args&&... p_args)
   {
+    record_allocation<T>(sizeof(T));
     return m_allocator.new_object<T>(std::forward<Args>(p_args)...);
   }
 
+  /// Returns the memory allocated in the context by kind of object (for
+  /// -fmem-report).
+  [[nodiscard]] PContextMemoryUsage get_memory_usage() const;
+  /// Adds the memory usage of the context to the memory report.
+  void report_memory_usage() const;
+
+  /// Returns a NUL-terminated copy of p_string allocated in the context.
+  /// Equal strings are only stored once, and thus have the same address.
+  [[nodiscard]] std::string_view intern_string(std::string_view p_string);
+
   [[nodiscard]] PType* get_void_ty() { return &m_void_ty; }
   [[nodiscard]] PType* get_char_ty() { return &m_char_ty; }
   [[nodiscard]] PType* get_bool_ty() { return &m_bool_ty; }
@@ -53,7 +100,34 @@ public:
   [[nodiscard]] PUnknownType* get_unknown_ty(PIdentifierInfo* p_name);
 
 private:
+  /// Accounts an allocation of p_size bytes for objects of type T in
+  /// m_memory_usage, if T is an AST node, a type or a symbol.
+  template<class T>
+  void record_allocation(size_t p_size)
+  {
+    PMemRecord* entry;
+    if constexpr (requires { T::STMT_KIND; })
+      entry = &m_memory_usage.stmts[T::STMT_KIND];
+    else if constexpr (requires { T::DECL_KIND; })
+      entry = &m_memory_usage.decls[T::DECL_KIND];
+    else if constexpr (requires { T::TYPE_KIND; })
+      entry = &m_memory_usage.types[T::TYPE_KIND];
+    else if constexpr (std::is_same_v<T, PSymbol>)
+      entry = &m_memory_usage.symbols;
+    else
+      return;
+
+    entry->bytes += p_size;
+    entry->count += 1;
+  }
+
   PBumpAllocator m_allocator;
+  // Only the fields of the AST nodes, types and symbols are filled, the
+  // others are computed by get_memory_usage().
+  PContextMemoryUsage m_memory_usage;
+  // The hash tables below live as long as the context, so their buckets are
+  // allocated in it.
+  PHashSet<std::string_view> m_strings{ &m_allocator };
 
   // Builtin types:
   PType m_void_ty{ PTypeKind::P_TK_VOID };
@@ -72,13 +146,8 @@ private:
 
   // Composite types:
 
-  std::unordered_map<PType*, PPointerType*> m_pointer_tys;
-  std::unordered_map<PDecl*, PTagType*> m_tag_tys;
-
-  [[nodiscard]] static inline size_t hash_combine(size_t p_lhs, size_t p_rhs) noexcept
-  {
-    return p_lhs ^ (p_rhs + 0x9e3779b9 + (p_lhs << 6) + (p_lhs >> 2));
-  }
+  PHashMap<PType*, PPointerType*> m_pointer_tys{ &m_allocator };
+  PHashMap<PDecl*, PTagType*> m_tag_tys{ &m_allocator };
 
   struct FuncTyKey
   {
@@ -91,34 +160,36 @@ private:
     }
   };
 
-  /// Implementation of the std::hash interface for FuncTyKey
   struct FuncTyKeyHash
   {
-    [[nodiscard]] size_t operator()(const FuncTyKey& p_key) const noexcept
+    [[nodiscard]] uint64_t operator()(const FuncTyKey& p_key) const noexcept
     {
-      auto hasher = std::hash<PType*>{};
-      size_t hval = hasher(p_key.ret_ty);
-      for (auto* param : p_key.params) {
-        hval = hash_combine(hval, hasher(param));
-      }
-      return hval;
+      uint64_t hash = PHash<PType*>{}(p_key.ret_ty);
+      for (auto* param : p_key.params)
+        hash = p_hash_mix(hash, reinterpret_cast<uintptr_t>(param));
+      return hash;
     }
   };
 
-  std::unordered_map<FuncTyKey, PFunctionType*, FuncTyKeyHash> m_func_tys;
+  PHashMap<FuncTyKey, PFunctionType*, FuncTyKeyHash> m_func_tys{ &m_allocator };
+
+  struct ArrayTyKey
+  {
+    PType* elt_ty;
+    size_t num_elements;
+
+    [[nodiscard]] bool operator==(const ArrayTyKey& p_key) const noexcept = default;
+  };
 
-  /// Implementation of the std::hash interface for std::pair<PType*, size_t>.
-  struct PairHash
+  struct ArrayTyKeyHash
   {
-    [[nodiscard]] size_t operator()(std::pair<PType*, size_t> p_val) const noexcept
+    [[nodiscard]] uint64_t operator()(const ArrayTyKey& p_key) const noexcept
     {
-      const size_t lhs = std::hash<PType*>{}(p_val.first);
-      const size_t rhs = std::hash<size_t>{}(p_val.second);
-      return hash_combine(lhs, rhs);
+      return p_hash_mix(PHash<PType*>{}(p_key.elt_ty), p_key.num_elements);
     }
   };
 
-  std::unordered_map<std::pair<PType*, size_t>, PArrayType*, PairHash> m_array_tys;
+  PHashMap<ArrayTyKey, PArrayType*, ArrayTyKeyHash> m_array_tys{ &m_allocator };
 };
 
 #endif // PEONY_CONTEXT_HXX
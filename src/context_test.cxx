@@ -0,0 +1,64 @@
+#include "context.hxx"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+TEST(context, intern_string)
+{
+  PContext context;
+
+  std::string foo = "foo";
+  const auto interned_foo = context.intern_string(foo);
+  EXPECT_EQ(interned_foo, "foo");
+  EXPECT_NE(interned_foo.data(), foo.data());
+  EXPECT_EQ(interned_foo.data()[interned_foo.size()], '\0');
+
+  // Equal strings are only stored once.
+  foo = "bar"; // the interned string is a copy
+  EXPECT_EQ(context.intern_string("foo").data(), interned_foo.data());
+  EXPECT_EQ(interned_foo, "foo");
+
+  const auto interned_bar = context.intern_string(foo);
+  EXPECT_EQ(interned_bar, "bar");
+  EXPECT_NE(interned_bar.data(), interned_foo.data());
+
+  EXPECT_EQ(context.intern_string("").size(), 0);
+}
+
+TEST(context, independent_contexts)
+{
+  auto context = std::make_unique<PContext>();
+  PContext other_context;
+
+  // The types are unique in a context only.
+  PType* pointer_ty = context->get_pointer_ty(context->get_i32_ty());
+  EXPECT_EQ(context->get_pointer_ty(context->get_i32_ty()), pointer_ty);
+  EXPECT_NE(other_context.get_pointer_ty(other_context.get_i32_ty()), pointer_ty);
+
+  EXPECT_GT(context->get_allocator().get_reserved_bytes(), 0);
+  context.reset(); // releases all its memory
+  EXPECT_EQ(other_context.get_pointer_ty(other_context.get_i32_ty())->get_element_ty(), other_context.get_i32_ty());
+}
+
+TEST(context, memory_usage)
+{
+  PContext context;
+  (void)context.get_pointer_ty(context.get_i32_ty());
+  (void)context.get_pointer_ty(context.get_i32_ty()); // already exists
+  (void)context.get_pointer_ty(context.get_pointer_ty(context.get_i32_ty()));
+  (void)context.intern_string("foo");
+
+  const auto usage = context.get_memory_usage();
+  EXPECT_EQ(usage.types[P_TK_POINTER].count, 2);
+  EXPECT_EQ(usage.types[P_TK_POINTER].bytes, 2 * sizeof(PPointerType));
+  EXPECT_EQ(usage.types[P_TK_I32].count, 0); // builtin types are not allocated
+  EXPECT_EQ(usage.strings.count, 1);
+  EXPECT_EQ(usage.strings.bytes, 4);
+  EXPECT_GT(usage.hash_table_bytes, 0);
+
+  // Every allocated byte is counted once.
+  EXPECT_EQ(usage.types[P_TK_POINTER].bytes + usage.strings.bytes + usage.hash_table_bytes + usage.other_bytes,
+            context.get_allocator().get_allocated_bytes());
+}
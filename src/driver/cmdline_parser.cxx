@@ -77,29 +77,64 @@ parse_feature_option_int(const char* p_name, int* p_var, const char* p_arg)
   return true;
 }
 
+static bool
+parse_feature_option_string(const char* p_name, const char** p_var, const char* p_arg)
+{
+  p_arg += 2; // skip '-f'
+
+  size_t name_len = strlen(p_name) - 2; // the two first characters are always '-f'
+  if (strncmp(p_name + 2, p_arg, name_len) != 0)
+    return false;
+
+  p_arg += name_len;
+  if (*p_arg == '\0' || (*p_arg == '=' && p_arg[1] == '\0')) {
+    PDiag* d = diag(P_DK_err_missing_argument_cmdline_opt);
+    diag_add_arg_str(d, p_name);
+    diag_flush(d);
+    return true; // there is no argument but this is the correct option so skip it
+  }
+
+  if (*p_arg != '=')
+    return false;
+
+  *p_var = p_arg + 1;
+  return true;
+}
+
 static bool
 parse_optimization_level(const char* p_arg)
 {
   assert(p_arg[0] == '-' && p_arg[1] == 'O');
   p_arg += 2;
 
-  POptimizationLevel level;
-  if (strcmp(p_arg, "0") == 0)
-    level = P_OPT_O0;
-  else if (strcmp(p_arg, "1") == 0)
-    level = P_OPT_O1;
-  else if (strcmp(p_arg, "2") == 0)
-    level = P_OPT_O2;
-  else if (strcmp(p_arg, "3") == 0)
-    level = P_OPT_O3;
-  else if (strcmp(p_arg, "z") == 0)
-    level = P_OPT_Oz;
-  else if (strcmp(p_arg, "s") == 0)
-    level = P_OPT_Os;
-  else
-    return false;
+#define OPTIMIZATION_LEVEL(p_name, p_level)                                                                            \
+  if (strcmp(p_arg, p_name) == 0) {                                                                                    \
+    g_options.opt_optimization_level = P_OPT_##p_level;                                                                \
+    return true;                                                                                                       \
+  }
+#include "../options.def"
 
-  g_options.opt_optimization_level = level;
+  return false;
+}
+
+static bool
+parse_int_argument(const char* p_opt, const char* p_arg, int* p_var)
+{
+  int value = 0;
+  do {
+    if (*p_arg < '0' || *p_arg > '9') {
+      PDiag* d = diag(P_DK_err_cmdline_opt_expect_int);
+      diag_add_arg_str(d, p_opt);
+      diag_flush(d);
+      return false;
+    }
+
+    value *= 10;
+    value += *p_arg - '0';
+    p_arg++;
+  } while (*p_arg != '\0');
+
+  *p_var = value;
   return true;
 }
 
@@ -115,12 +150,20 @@ cmdline_parser(int p_argc, char* p_argv[])
     }
 
     if (memcmp(arg, "-f", 2) == 0) {
+#define LTO_MODE(p_opt, p_mode)                                                                                        \
+  if (strcmp(p_opt, arg) == 0) {                                                                                       \
+    g_options.opt_lto = P_LTO_##p_mode;                                                                                \
+    continue;                                                                                                          \
+  }
 #define FEATURE_OPTION_SWITCH(p_opt, p_var, p_default)                                                                 \
   if (parse_feature_option_switch(p_opt, &g_options.p_var, arg))                                                       \
     continue;
 #define FEATURE_OPTION_INT(p_opt, p_var, p_default)                                                                    \
   if (parse_feature_option_int("-f" p_opt, &g_options.p_var, arg))                                                     \
     continue;
+#define FEATURE_OPTION_STRING(p_opt, p_var, p_default)                                                                 \
+  if (parse_feature_option_string("-f" p_opt, &g_options.p_var, arg))                                                  \
+    continue;
 #include "../options.def"
     } else if (memcmp(arg, "-O", 2) == 0 && parse_optimization_level(arg)) {
       continue;
@@ -137,6 +180,22 @@ cmdline_parser(int p_argc, char* p_argv[])
       i++;
       g_options.output_file = p_argv[i];
       continue;
+    } else if (memcmp(arg, "-j", 2) == 0) {
+      // Either `-jN` or `-j N`.
+      const char* value = arg + 2;
+      if (*value == '\0') {
+        if (i + 1 >= p_argc) {
+          PDiag* d = diag(P_DK_err_missing_argument_cmdline_opt);
+          diag_add_arg_str(d, "-j");
+          diag_flush(d);
+          return;
+        }
+
+        value = p_argv[++i];
+      }
+
+      parse_int_argument("-j", value, &g_options.opt_jobs);
+      continue;
     }
 
 #define OPTION(p_opt, p_var)                                                                                           \
@@ -145,6 +204,11 @@ cmdline_parser(int p_argc, char* p_argv[])
     continue;                                                                                                          \
   }
 #define FEATURE_OPTION(p_opt, p_var)
+#define EMIT_KIND(p_opt, p_kind, p_extension)                                                                          \
+  if (strcmp(p_opt, arg) == 0) {                                                                                       \
+    g_options.opt_emit = P_EMIT_##p_kind;                                                                              \
+    continue;                                                                                                          \
+  }
 #include "../options.def"
 
     PDiag* d = diag(P_DK_err_unknown_cmdline_opt);
@@ -159,7 +223,22 @@ cmdline_parser(int p_argc, char* p_argv[])
     return;
   }
 
-  if (g_options.output_file == nullptr) {
+  if (g_options.opt_incremental_codegen && g_options.opt_cache_dir == nullptr) {
+    PDiag* d = diag(P_DK_warn_cmdline_opt_ignored_without);
+    diag_add_arg_str(d, "-fincremental-codegen");
+    diag_add_arg_str(d, "-fcache-dir");
+    diag_flush(d);
+  }
+
+  if (g_options.opt_emit != P_EMIT_EXECUTABLE) {
+    // Each input file produces its own output file, whose name is by default
+    // derived from the input file name.
+    if (g_options.output_file != nullptr && g_options.input_files.size() > 1) {
+      PDiag* d = diag(P_DK_err_output_file_with_multiple_inputs);
+      diag_add_arg_str(d, "-o");
+      diag_flush(d);
+    }
+  } else if (g_options.output_file == nullptr) {
 #ifdef _WIN32
     g_options.output_file = "a.exe";
 #else
@@ -0,0 +1,303 @@
+#include "compile_cache.hxx"
+
+#include "../codegen_llvm.hxx"
+#include "../options.hxx"
+#include "../utils/source_file.hxx"
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+// Once the maximum size is exceeded, the cache is trimmed to this fraction of
+// its maximum size so that it does not have to be trimmed again by the next
+// compilations.
+#define P_CACHE_TRIM_RATIO 0.9
+// Temporary files older than this are left over by killed compilers.
+#define P_CACHE_STALE_TEMPORARY_AGE std::chrono::hours(1)
+
+static const char* const g_temporary_suffix = ".tmp";
+
+static void
+hash_bytes(llvm::SHA256& p_hasher, const void* p_data, size_t p_size)
+{
+  // Each value is prefixed by its size so that consecutive values can not be
+  // confused with others (e.g. "ab" + "c" and "a" + "bc").
+  uint64_t size = p_size;
+  p_hasher.update(llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(&size), sizeof(size)));
+  p_hasher.update(llvm::ArrayRef<uint8_t>(static_cast<const uint8_t*>(p_data), p_size));
+}
+
+static void
+hash_option(llvm::SHA256& p_hasher, bool p_value)
+{
+  hash_bytes(p_hasher, &p_value, sizeof(p_value));
+}
+
+static void
+hash_option(llvm::SHA256& p_hasher, int p_value)
+{
+  hash_bytes(p_hasher, &p_value, sizeof(p_value));
+}
+
+static void
+hash_option(llvm::SHA256& p_hasher, const char* p_value)
+{
+  if (p_value == nullptr)
+    p_value = "";
+  hash_bytes(p_hasher, p_value, strlen(p_value));
+}
+
+/// Returns true if the option p_var (the name of the POptions field) can not
+/// change the generated object file. The cache is only used when a compilation
+/// emits no diagnostic, so the diagnostic options are ignored too. Any option
+/// not listed here is part of the cache keys.
+static bool
+is_option_ignored_by_cache(const char* p_var)
+{
+  static const char* const ignored_options[] = {
+    "opt_run",
+    "opt_syntax_only",
+    "opt_dump_ast",
+    "opt_dump_ir",
+    "opt_diagnostics_color",
+    "opt_diagnostics_show_line_numbers",
+    "opt_diagnostics_minimum_margin_width",
+    "opt_diagnostics_show_column",
+    "opt_diagnostics_column_origin",
+    "opt_diagnostics_max_errors",
+    "opt_w_fatal_erros",
+    "opt_time_report",
+    "opt_time_trace",
+    "opt_mem_report",
+    "opt_cache_dir",
+    "opt_cache_max_size",
+    "opt_cache_stats",
+    "opt_incremental_codegen",
+    "opt_prelex",
+    "opt_huge_pages",
+  };
+
+  for (const char* ignored_option : ignored_options) {
+    if (strcmp(ignored_option, p_var) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+static void
+hash_options(llvm::SHA256& p_hasher)
+{
+#define HASH_OPTION(p_var)                                                                                             \
+  if (!is_option_ignored_by_cache(#p_var)) {                                                                           \
+    hash_bytes(p_hasher, #p_var, strlen(#p_var));                                                                      \
+    hash_option(p_hasher, g_options.p_var);                                                                            \
+  }
+#define OPTION(p_opt, p_var) HASH_OPTION(p_var)
+#define FEATURE_OPTION_SWITCH(p_opt, p_var, p_default) HASH_OPTION(p_var)
+#define FEATURE_OPTION_INT(p_opt, p_var, p_default) HASH_OPTION(p_var)
+#define FEATURE_OPTION_STRING(p_opt, p_var, p_default) HASH_OPTION(p_var)
+#include "../options.def"
+#undef HASH_OPTION
+
+  hash_option(p_hasher, (int)g_options.opt_optimization_level);
+  hash_option(p_hasher, (int)g_options.opt_lto);
+  // With -flto, the executable builds cache LLVM bitcode while the -c ones
+  // cache native object files.
+  hash_option(p_hasher, (int)g_options.opt_emit);
+}
+
+PCompileCache::PCompileCache(std::string p_directory, uint64_t p_max_size, const char* p_argv0)
+  : m_directory(std::move(p_directory))
+  , m_max_size(p_max_size)
+{
+  // The compiler executable is identified by its path, size and modification
+  // time (like ccache does) which is much cheaper than hashing its content.
+  static int s_main_address_anchor;
+  std::string executable = llvm::sys::fs::getMainExecutable(p_argv0, &s_main_address_anchor);
+  llvm::sys::fs::file_status status;
+  if (!llvm::sys::fs::status(executable, status)) {
+    executable += ";" + std::to_string(status.getSize());
+    executable += ";" + std::to_string(status.getLastModificationTime().time_since_epoch().count());
+  }
+
+  m_compiler_id = executable + ";" LLVM_VERSION_STRING ";" + PCodeGenLLVM::get_target_id();
+}
+
+void
+PCompileCache::hash_common(llvm::SHA256& p_hasher, const PSourceFile& p_source_file) const
+{
+  hash_bytes(p_hasher, m_compiler_id.data(), m_compiler_id.size());
+  hash_options(p_hasher);
+
+  // The file name is part of the debug information.
+  const auto& filename = p_source_file.get_filename();
+  hash_bytes(p_hasher, filename.data(), filename.size());
+}
+
+std::string
+PCompileCache::compute_key(const PSourceFile& p_source_file) const
+{
+  llvm::SHA256 hasher;
+  hash_common(hasher, p_source_file);
+
+  const auto& buffer = p_source_file.get_buffer();
+  hash_bytes(hasher, buffer.data(), buffer.size());
+
+  return llvm::toHex(hasher.final(), /* LowerCase= */ true);
+}
+
+std::string
+PCompileCache::compute_function_key(const PSourceFile& p_source_file, const std::string& p_function_hash) const
+{
+  llvm::SHA256 hasher;
+  hash_common(hasher, p_source_file);
+
+  // Distinguishes the function entries from the translation unit ones.
+  static const char function_tag[] = "function";
+  hash_bytes(hasher, function_tag, sizeof(function_tag) - 1);
+  hash_bytes(hasher, p_function_hash.data(), p_function_hash.size());
+
+  return llvm::toHex(hasher.final(), /* LowerCase= */ true);
+}
+
+std::string
+PCompileCache::get_entry_path(const std::string& p_key) const
+{
+  // Entries are spread over 256 subdirectories to keep directories small.
+  llvm::SmallString<256> path(m_directory);
+  llvm::sys::path::append(path, llvm::StringRef(p_key).take_front(2), llvm::StringRef(p_key).drop_front(2) + ".o");
+  return std::string(path.str());
+}
+
+bool
+PCompileCache::lookup(const std::string& p_key, std::string& p_object)
+{
+  const auto path = get_entry_path(p_key);
+  auto buffer = llvm::MemoryBuffer::getFile(path, /* IsText= */ false, /* RequiresNullTerminator= */ false);
+  // An empty entry is never a valid object file (e.g. stored by an older
+  // compiler for a translation unit whose code was not generated).
+  if (!buffer || (*buffer)->getBufferSize() == 0) {
+    m_miss_count += 1;
+    return false;
+  }
+
+  p_object.assign((*buffer)->getBufferStart(), (*buffer)->getBufferSize());
+
+  // Mark the entry as recently used for the LRU eviction.
+  int fd;
+  if (!llvm::sys::fs::openFileForWrite(path, fd, llvm::sys::fs::CD_OpenExisting, llvm::sys::fs::OF_Append)) {
+    llvm::sys::TimePoint<> now = std::chrono::system_clock::now();
+    llvm::sys::fs::setLastAccessAndModificationTime(fd, now, now);
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+  }
+
+  m_hit_count += 1;
+  return true;
+}
+
+void
+PCompileCache::store(const std::string& p_key, const std::string& p_object)
+{
+  const auto path = get_entry_path(p_key);
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path)))
+    return;
+
+  // The entry is written to a temporary file then renamed, which is atomic.
+  // Other compilers sharing the cache never see a partially written entry.
+  int fd;
+  llvm::SmallString<256> temporary_path;
+  if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%%%" + g_temporary_suffix, fd, temporary_path))
+    return;
+
+  llvm::raw_fd_ostream stream(fd, /* shouldClose= */ true);
+  stream.write(p_object.data(), p_object.size());
+  stream.close();
+
+  if (stream.has_error() || llvm::sys::fs::rename(temporary_path, path)) {
+    stream.clear_error();
+    llvm::sys::fs::remove(temporary_path);
+    return;
+  }
+
+  m_store_count += 1;
+}
+
+void
+PCompileCache::trim()
+{
+  // The cache only grows when entries are stored.
+  if (m_store_count == 0)
+    return;
+
+  struct PEntry
+  {
+    std::string path;
+    uint64_t size;
+    llvm::sys::TimePoint<> last_use;
+  };
+
+  std::vector<PEntry> entries;
+  uint64_t total_size = 0;
+  const llvm::sys::TimePoint<> now = std::chrono::system_clock::now();
+
+  std::error_code ec;
+  for (llvm::sys::fs::recursive_directory_iterator it(m_directory, ec), end; it != end && !ec; it.increment(ec)) {
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(it->path(), status) || status.type() != llvm::sys::fs::file_type::regular_file)
+      continue;
+
+    if (llvm::StringRef(it->path()).endswith(g_temporary_suffix)) {
+      if (now - status.getLastModificationTime() > P_CACHE_STALE_TEMPORARY_AGE)
+        llvm::sys::fs::remove(it->path());
+      continue;
+    }
+
+    entries.push_back({ it->path(), status.getSize(), status.getLastModificationTime() });
+    total_size += status.getSize();
+  }
+
+  if (total_size > m_max_size) {
+    std::sort(entries.begin(), entries.end(), [](const PEntry& p_lhs, const PEntry& p_rhs) {
+      return p_lhs.last_use < p_rhs.last_use;
+    });
+
+    const auto target_size = static_cast<uint64_t>(m_max_size * P_CACHE_TRIM_RATIO);
+    for (const auto& entry : entries) {
+      if (total_size <= target_size)
+        break;
+
+      if (!llvm::sys::fs::remove(entry.path)) {
+        total_size -= entry.size;
+        m_eviction_count += 1;
+      }
+    }
+  }
+
+  m_size = total_size;
+}
+
+void
+PCompileCache::print_stats(FILE* p_stream) const
+{
+  const unsigned lookup_count = m_hit_count + m_miss_count;
+  const double hit_rate = lookup_count == 0 ? 0.0 : m_hit_count * 100.0 / lookup_count;
+
+  fprintf(p_stream, "Compilation cache statistics (%s):\n", m_directory.c_str());
+  fprintf(p_stream, "  hits:      %u (%.1f%%)\n", m_hit_count.load(), hit_rate);
+  fprintf(p_stream, "  misses:    %u\n", m_miss_count.load());
+  fprintf(p_stream, "  stores:    %u\n", m_store_count.load());
+  fprintf(p_stream, "  evictions: %u\n", m_eviction_count);
+  if (m_store_count != 0) // the size is only known once trimmed
+    fprintf(p_stream, "  size:      %.2f / %.2f MiB\n", m_size / 1048576.0, m_max_size / 1048576.0);
+}
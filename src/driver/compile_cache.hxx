@@ -0,0 +1,65 @@
+#ifndef PEONY_COMPILE_CACHE_HXX
+#define PEONY_COMPILE_CACHE_HXX
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct PSourceFile;
+
+namespace llvm {
+class SHA256;
+}
+
+/// A content-addressed cache of object files (-fcache-dir).
+///
+/// The key of an entry is a hash of everything that can change the object
+/// produced for a source file: its content and name, the options, the target
+/// and the compiler itself. Entries are files of the cache directory; they are
+/// written atomically (so several compilers can share the cache) and evicted
+/// in least recently used order once the cache exceeds its maximum size.
+class PCompileCache
+{
+public:
+  PCompileCache(std::string p_directory, uint64_t p_max_size, const char* p_argv0);
+
+  /// Returns the key of the object file compiled from p_source_file with the
+  /// current options.
+  [[nodiscard]] std::string compute_key(const PSourceFile& p_source_file) const;
+  /// Returns the key of the object file of a single function of p_source_file
+  /// (see -fincremental-codegen) given its structural hash (see PAstHasher).
+  [[nodiscard]] std::string compute_function_key(const PSourceFile& p_source_file,
+                                                 const std::string& p_function_hash) const;
+
+  /// Retrieves the object file of the entry p_key into p_object. Returns false
+  /// if there is no such entry.
+  bool lookup(const std::string& p_key, std::string& p_object);
+  /// Adds (or replaces) the entry p_key.
+  void store(const std::string& p_key, const std::string& p_object);
+
+  /// Evicts the least recently used entries until the cache fits in its
+  /// maximum size. Does nothing if no entry was stored by this compiler.
+  void trim();
+
+  void print_stats(FILE* p_stream) const;
+
+private:
+  /// Hashes the parts common to all keys: the compiler, the options and the
+  /// name of the source file.
+  void hash_common(llvm::SHA256& p_hasher, const PSourceFile& p_source_file) const;
+  [[nodiscard]] std::string get_entry_path(const std::string& p_key) const;
+
+  std::string m_directory;
+  uint64_t m_max_size;
+  // Identifies the compiler executable and the LLVM version, part of all keys.
+  std::string m_compiler_id;
+
+  std::atomic<unsigned> m_hit_count = 0;
+  std::atomic<unsigned> m_miss_count = 0;
+  std::atomic<unsigned> m_store_count = 0;
+  unsigned m_eviction_count = 0;
+  uint64_t m_size = 0; // size after the last trim()
+};
+
+#endif // PEONY_COMPILE_CACHE_HXX
@@ -0,0 +1,129 @@
+#include "linker.hxx"
+
+#include "linker_command.hxx"
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+
+#ifdef P_HAS_LLD
+#include <lld/Common/Driver.h>
+#endif
+
+#include <cstring>
+#include <memory>
+
+/// An object materialized on disk for the duration of the link. Linkers only
+/// accept file names as inputs, so the in-memory objects are written to the
+/// temporary directory (usually a tmpfs) just before linking.
+struct PTemporaryObject
+{
+  llvm::SmallString<128> path;
+  std::unique_ptr<llvm::FileRemover> remover;
+};
+
+static bool
+write_temporary_object(const PObjectBuffer& p_object, PTemporaryObject& p_temp)
+{
+  int fd;
+  auto stem = llvm::sys::path::stem(p_object.name);
+  if (auto ec = llvm::sys::fs::createTemporaryFile(stem, "o", fd, p_temp.path)) {
+    llvm::errs() << "Could not create a temporary file: " << ec.message() << "\n";
+    return false;
+  }
+
+  p_temp.remover = std::make_unique<llvm::FileRemover>(p_temp.path);
+
+  llvm::raw_fd_ostream stream(fd, /* shouldClose= */ true);
+  stream.write(p_object.data.data(), p_object.data.size());
+  stream.close();
+  if (stream.has_error()) {
+    llvm::errs() << "Could not write file '" << p_temp.path << "': " << stream.error().message() << "\n";
+    stream.clear_error();
+    return false;
+  }
+
+  return true;
+}
+
+/// Expands the placeholders of P_LINKER_COMMAND.
+static std::vector<std::string>
+build_link_command(const std::vector<PTemporaryObject>& p_objects, const std::string& p_output_file)
+{
+  static const char* const command_template[] = { P_LINKER_COMMAND };
+
+  std::vector<std::string> args;
+  for (const char* arg : command_template) {
+    if (strcmp(arg, "@objects@") == 0) {
+      for (const auto& object : p_objects)
+        args.emplace_back(object.path.str());
+    } else if (strcmp(arg, "@output@") == 0) {
+      args.push_back(p_output_file);
+    } else {
+      args.emplace_back(arg);
+    }
+  }
+
+  return args;
+}
+
+#ifdef P_HAS_LLD
+static bool
+run_lld(const std::vector<std::string>& p_args)
+{
+  std::vector<const char*> argv;
+  argv.push_back("ld.lld");
+  // Skip the detected linker program name.
+  for (size_t i = 1; i < p_args.size(); ++i)
+    argv.push_back(p_args[i].c_str());
+
+  return lld::elf::link(argv, llvm::outs(), llvm::errs(), /* exitEarly= */ false, /* disableOutput= */ false);
+}
+#else
+static bool
+run_system_linker(const std::vector<std::string>& p_args)
+{
+  std::string program = p_args.front();
+  if (!llvm::sys::path::is_absolute(program)) {
+    auto program_path = llvm::sys::findProgramByName(program);
+    if (!program_path) {
+      llvm::errs() << "Could not find the linker '" << program << "'\n";
+      return false;
+    }
+
+    program = *program_path;
+  }
+
+  std::vector<llvm::StringRef> argv(p_args.begin(), p_args.end());
+
+  std::string error_msg;
+  int result = llvm::sys::ExecuteAndWait(program, argv, llvm::None, {}, 0, 0, &error_msg);
+  if (result < 0) {
+    llvm::errs() << "Could not run the linker '" << program << "': " << error_msg << "\n";
+    return false;
+  }
+
+  return result == 0;
+}
+#endif
+
+bool
+link_executable(const std::vector<PObjectBuffer>& p_objects, const std::string& p_output_file)
+{
+  std::vector<PTemporaryObject> objects(p_objects.size());
+  for (size_t i = 0; i < p_objects.size(); ++i) {
+    if (!write_temporary_object(p_objects[i], objects[i]))
+      return false;
+  }
+
+  const auto args = build_link_command(objects, p_output_file);
+
+#ifdef P_HAS_LLD
+  return run_lld(args);
+#else
+  return run_system_linker(args);
+#endif
+}
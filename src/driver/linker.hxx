@@ -0,0 +1,22 @@
+#ifndef PEONY_LINKER_HXX
+#define PEONY_LINKER_HXX
+
+#include <string>
+#include <vector>
+
+/// An object file generated in memory by the code generator.
+struct PObjectBuffer
+{
+  std::string name; // the source file name, used for error messages
+  std::string data;
+};
+
+/// Links the given objects into the executable p_output_file.
+///
+/// The link is done in-process by LLD when peony is built with it. Otherwise,
+/// the system linker is invoked directly (no shell nor compiler driver) with
+/// the command line detected at configure time.
+bool
+link_executable(const std::vector<PObjectBuffer>& p_objects, const std::string& p_output_file);
+
+#endif // PEONY_LINKER_HXX
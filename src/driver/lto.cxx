@@ -0,0 +1,93 @@
+#include "lto.hxx"
+
+#include "../codegen_llvm.hxx"
+
+#include <llvm/ADT/StringSet.h>
+#include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/IR/DiagnosticPrinter.h>
+#include <llvm/LTO/LTO.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/raw_ostream.h>
+
+bool
+link_time_optimize(PLtoMode p_mode,
+                   const std::vector<PObjectBuffer>& p_bitcodes,
+                   unsigned p_thread_count,
+                   std::vector<PObjectBuffer>& p_objects)
+{
+  llvm::lto::Config config;
+  PCodeGenLLVM::init_lto_config(config);
+  config.DefaultTriple = llvm::sys::getDefaultTargetTriple();
+  config.DiagHandler = [](const llvm::DiagnosticInfo& p_info) {
+    llvm::DiagnosticPrinterRawOStream printer(llvm::errs());
+    p_info.print(printer);
+    llvm::errs() << "\n";
+  };
+
+  llvm::lto::ThinBackend backend;
+  if (p_mode == P_LTO_THIN)
+    backend = llvm::lto::createInProcessThinBackend(llvm::heavyweight_hardware_concurrency(p_thread_count));
+
+  llvm::lto::LTO lto(std::move(config), std::move(backend));
+
+  llvm::StringSet<> module_ids;
+  llvm::StringSet<> defined_symbols;
+  std::vector<std::string> buffer_ids;
+  buffer_ids.reserve(p_bitcodes.size());
+  for (const auto& bitcode : p_bitcodes) {
+    // ThinLTO requires unique module identifiers, but several input files
+    // may have the same name (in different directories).
+    auto& id = buffer_ids.emplace_back(bitcode.name);
+    if (!module_ids.insert(id).second)
+      id += "." + std::to_string(buffer_ids.size());
+
+    auto input = llvm::lto::InputFile::create(llvm::MemoryBufferRef(bitcode.data, id));
+    if (!input) {
+      llvm::errs() << bitcode.name << ": " << llvm::toString(input.takeError()) << "\n";
+      return false;
+    }
+
+    std::vector<llvm::lto::SymbolResolution> resolutions;
+    for (const auto& symbol : (*input)->symbols()) {
+      llvm::lto::SymbolResolution resolution;
+      if (!symbol.isUndefined()) {
+        if (!defined_symbols.insert(symbol.getName()).second) {
+          llvm::errs() << bitcode.name << ": duplicate symbol '" << symbol.getName() << "'\n";
+          return false;
+        }
+
+        resolution.Prevailing = true;
+      }
+
+      // Only main() is referenced from outside the program (by the C
+      // runtime). All other symbols can be internalized.
+      resolution.VisibleToRegularObj = symbol.getName() == "main";
+      resolutions.push_back(resolution);
+    }
+
+    if (auto error = lto.add(std::move(*input), resolutions)) {
+      llvm::errs() << bitcode.name << ": " << llvm::toString(std::move(error)) << "\n";
+      return false;
+    }
+  }
+
+  // One output per task: the merged module of the full LTO and each module
+  // of the ThinLTO. Tasks run concurrently but each has its own buffer.
+  std::vector<llvm::SmallString<0>> buffers(lto.getMaxTasks());
+  auto add_stream = [&buffers](unsigned p_task) {
+    return std::make_unique<llvm::CachedFileStream>(std::make_unique<llvm::raw_svector_ostream>(buffers[p_task]));
+  };
+
+  if (auto error = lto.run(add_stream)) {
+    llvm::errs() << llvm::toString(std::move(error)) << "\n";
+    return false;
+  }
+
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    if (!buffers[i].empty())
+      p_objects.push_back({ "lto-" + std::to_string(i) + ".o", std::string(buffers[i].str()) });
+  }
+
+  return true;
+}
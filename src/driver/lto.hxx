@@ -0,0 +1,25 @@
+#ifndef PEONY_LTO_HXX
+#define PEONY_LTO_HXX
+
+#include "../options.hxx"
+#include "linker.hxx"
+
+/// Optimizes the bitcode of all the translation units (as written by
+/// PCodeGenLLVM::write_lto_bitcode_to_memory()) as a whole program and
+/// generates the resulting native objects into p_objects (-flto).
+///
+/// With full LTO, the modules are linked into a single module which is then
+/// optimized and compiled at once. With ThinLTO, the modules are optimized and
+/// compiled separately on up to p_thread_count threads, after importing from
+/// the other modules the functions selected by the thin link (based on the
+/// module summaries).
+///
+/// Returns false, after printing an error, if a bitcode file is invalid or a
+/// symbol is defined by several translation units.
+bool
+link_time_optimize(PLtoMode p_mode,
+                   const std::vector<PObjectBuffer>& p_bitcodes,
+                   unsigned p_thread_count,
+                   std::vector<PObjectBuffer>& p_objects);
+
+#endif // PEONY_LTO_HXX
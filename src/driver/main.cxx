@@ -1,53 +1,460 @@
+#include "../ast/ast_hasher.hxx"
 #include "../codegen_llvm.hxx"
+#include "../jit_llvm.hxx"
 #include "../parser.hxx"
 
 #include "../options.hxx"
+#include "../utils/mem_report.hxx"
+#include "../utils/time_report.hxx"
+
+#include "compile_cache.hxx"
+#include "linker.hxx"
+#include "lto.hxx"
 
 #include <clocale>
 #include <cstdlib>
 
 #include <llvm/Support/TargetSelect.h>
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <thread>
 
-#include <fmt/format.h>
+#include <hedley.h>
 
 namespace fs = std::filesystem;
 
+/// A translation unit to compile and the results of its compilation.
+struct PCompileJob
+{
+  std::string input_file;
+  // The file produced when not linking an executable (-c, -S, etc.).
+  std::string output_file;
+  // The generated object file, kept in memory until the link.
+  PObjectBuffer object;
+  // With -fincremental-codegen, the object files of each function of the
+  // translation unit (object is then unused).
+  std::vector<PObjectBuffer> function_objects;
+  // With -fprelex, the count of threads that can lex the file concurrently.
+  unsigned lexing_thread_count = 1;
+  // Diagnostics of the job. Buffered in a temporary file when compiling
+  // several translation units concurrently, so they can be printed in the
+  // order of the input files once all jobs are finished.
+  FILE* diag_output = nullptr;
+  // Likewise for the AST dump (-fdump-ast) printed to the standard output.
+  // The IR dump (-fdump-ir) goes with the diagnostics to the standard error.
+  FILE* dump_output = nullptr;
+  int diagnostic_count[P_DIAG_SEVERITY_LAST] = { 0 };
+};
+
+/// Returns true if the translation units are optimized together at link time.
+/// Only executables are link-time optimized.
+static bool
+is_lto_enabled()
+{
+  return g_options.opt_lto != P_LTO_NONE && g_options.opt_emit == P_EMIT_EXECUTABLE && !g_options.opt_run;
+}
+
+/// Writes the in-memory object file of the job to its output file.
+static bool
+write_object_file(const PCompileJob& p_job)
+{
+  FILE* file = fopen(p_job.output_file.c_str(), "wb");
+  if (file == nullptr)
+    return false;
+
+  const auto& data = p_job.object.data;
+  bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+  return fclose(file) == 0 && success;
+}
+
+/// Writes the artifact requested by the command line (see PEmitKind) for the
+/// job. Returns false if the output file can not be written.
+static bool
+emit_output(PCodeGenLLVM& p_codegen, PCompileJob& p_job)
+{
+  switch (g_options.opt_emit) {
+    case P_EMIT_EXECUTABLE: {
+      if (is_lto_enabled()) {
+        // The object is generated at link time.
+        PTimeRegion region(P_TIME_GROUP_PHASES, "Bitcode output");
+        p_codegen.write_lto_bitcode_to_memory(g_options.opt_lto, p_job.object.data);
+        return true;
+      }
+
+      PTimeRegion region(P_TIME_GROUP_PHASES, "Object emission");
+      return p_codegen.write_object_to_memory(p_job.object.data);
+    }
+    case P_EMIT_OBJECT: {
+      // Emitted in memory first so that it can be stored in the cache.
+      PTimeRegion region(P_TIME_GROUP_PHASES, "Object emission");
+      return p_codegen.write_object_to_memory(p_job.object.data) && write_object_file(p_job);
+    }
+    case P_EMIT_ASSEMBLY: {
+      PTimeRegion region(P_TIME_GROUP_PHASES, "Assembly emission");
+      return p_codegen.write_assembly_file(p_job.output_file);
+    }
+    case P_EMIT_LLVM_IR: {
+      PTimeRegion region(P_TIME_GROUP_PHASES, "IR output");
+      return p_codegen.write_llvm_ir(p_job.output_file);
+    }
+    case P_EMIT_LLVM_BC: {
+      PTimeRegion region(P_TIME_GROUP_PHASES, "Bitcode output");
+      return p_codegen.write_llvm_bc(p_job.output_file);
+    }
+    default:
+      HEDLEY_UNREACHABLE_RETURN(false);
+  }
+}
+
+/// Compiles each function of p_ast separately into the object files of the
+/// job, reusing the ones of the unchanged functions from p_cache. Returns false
+/// if an object file can not be emitted.
+static bool
+codegen_functions(PContext& p_context, PAstTranslationUnit* p_ast, PCompileJob& p_job, PCompileCache& p_cache)
+{
+  PAstHasher hasher(p_context, p_ast->p_src_file);
+
+  for (auto* decl : p_ast->decls) {
+    if (decl->get_kind() != P_DK_FUNCTION || !decl->as<PFunctionDecl>()->has_body())
+      continue;
+
+    auto* func_decl = decl->as<PFunctionDecl>();
+
+    PTimeRegion region(P_TIME_GROUP_PHASES, "Function hashing");
+    const auto key = p_cache.compute_function_key(*p_ast->p_src_file, hasher.hash_function(func_decl));
+    region.stop();
+
+    auto& object = p_job.function_objects.emplace_back();
+    object.name = p_job.object.name;
+    if (p_cache.lookup(key, object.data))
+      continue;
+
+    PCodeGenLLVM codegen(p_context);
+
+    region.start(P_TIME_GROUP_PHASES, "Code generation");
+    codegen.codegen_function(p_ast, func_decl);
+    region.stop();
+
+    region.start(P_TIME_GROUP_PHASES, "Optimization");
+    codegen.optimize();
+    region.stop();
+
+    if (g_options.opt_mem_report)
+      codegen.report_module_size();
+
+    region.start(P_TIME_GROUP_PHASES, "Object emission");
+    if (!codegen.write_object_to_memory(object.data))
+      return false;
+    region.stop();
+
+    // Unlike the translation unit entries, the function entries are stored
+    // even if there are diagnostics: they are reported by the parsing which
+    // is never skipped.
+    p_cache.store(key, object.data);
+  }
+
+  return true;
+}
+
+/// Adds the memory used by the front-end to compile p_source_file to the
+/// memory report (-fmem-report).
+static void
+report_memory_usage(const PSourceFile& p_source_file,
+                    const PIdentifierTable& p_identifier_table,
+                    const PTokenBuffer& p_token_buffer,
+                    const PContext& p_context,
+                    const PParser& p_parser)
+{
+  p_context.report_memory_usage();
+
+  size_t identifier_bytes = p_identifier_table.get_memory_usage();
+  size_t identifier_count = p_identifier_table.size();
+  if (const auto* shared_table = p_identifier_table.get_shared_table()) {
+    identifier_bytes += shared_table->get_memory_usage();
+    identifier_count = shared_table->size();
+  }
+
+  mem_report_add(P_MEM_GROUP_OTHER, "Identifiers", identifier_bytes, identifier_count);
+  const PMemRecord scopes = p_parser.get_sema().get_scope_memory_usage();
+  mem_report_add(P_MEM_GROUP_OTHER, "Scopes (freed when popped)", scopes.bytes, scopes.count);
+  mem_report_add(P_MEM_GROUP_OTHER, "Tokens", p_token_buffer.get_memory_usage(), p_token_buffer.size());
+  mem_report_add(P_MEM_GROUP_OTHER, "Line maps", p_source_file.get_line_map().get_memory_usage(), 1);
+}
+
+/// Generates the code of the translation unit p_ast, see compile_to().
+static void
+generate_code(PContext& p_context,
+              PAstTranslationUnit* p_ast,
+              PCompileJob& p_job,
+              PJitLLVM* p_jit,
+              PCompileCache* p_function_cache)
+{
+  if (p_function_cache != nullptr) {
+    if (!codegen_functions(p_context, p_ast, p_job, *p_function_cache)) {
+      PDiag* d = diag(P_DK_err_fail_open_file);
+      diag_add_arg_str(d, p_job.output_file.c_str());
+      diag_flush(d);
+    }
+  } else {
+    PCodeGenLLVM codegen(p_context);
+
+    PTimeRegion region(P_TIME_GROUP_PHASES, "Code generation");
+    codegen.codegen(p_ast);
+    region.stop();
+
+    region.start(P_TIME_GROUP_PHASES, "Optimization");
+    codegen.optimize(is_lto_enabled() ? g_options.opt_lto : P_LTO_NONE);
+    region.stop();
+
+    if (g_options.opt_mem_report)
+      codegen.report_module_size();
+
+    if (g_options.opt_dump_ir) {
+      region.start(P_TIME_GROUP_PHASES, "IR dump");
+      codegen.dump_llvm_ir(diag_get_output());
+      region.stop();
+    }
+
+    if (p_jit != nullptr) {
+      region.start(P_TIME_GROUP_PHASES, "JIT module loading");
+      std::string error_message;
+      if (!p_jit->add_module(codegen, error_message)) {
+        PDiag* d = diag(P_DK_err_jit_add_module_failed);
+        diag_add_arg_str(d, p_job.input_file.c_str());
+        diag_add_arg_str(d, error_message.c_str());
+        diag_flush(d);
+      }
+    } else if (!emit_output(codegen, p_job)) {
+      PDiag* d = diag(P_DK_err_fail_open_file);
+      diag_add_arg_str(d, p_job.output_file.c_str());
+      diag_flush(d);
+    }
+  }
+}
+
+/// Compiles the given source file either to the output requested by the
+/// command line or, if p_jit is not null, into the JIT. If p_function_cache
+/// is not null, each function is compiled separately and cached in it
+/// (-fincremental-codegen).
 bool
-compile_to(PSourceFile* p_source_file, const char* p_output_filename)
+compile_to(PSourceFile* p_source_file, PCompileJob& p_job, PJitLLVM* p_jit, PCompileCache* p_function_cache)
 {
-  PIdentifierTable identifier_table;
-  identifier_table.register_keywords();
+  // The lexing threads intern their identifiers in a shared table, rather
+  // than merging their own tables afterwards.
+  const bool lex_in_parallel = g_options.opt_prelex && p_job.lexing_thread_count > 1;
+  PConcurrentIdentifierTable shared_identifier_table;
+  PIdentifierTable identifier_table(lex_in_parallel ? &shared_identifier_table : nullptr);
 
   PLexer lexer;
   lexer.identifier_table = &identifier_table;
   lexer.set_source_file(p_source_file);
 
-  PContext& context = PContext::get_global();
-  PParser parser(context, lexer);
+  PTokenBuffer token_buffer;
+  if (g_options.opt_prelex) {
+    PTimeRegion region(P_TIME_GROUP_PHASES, "Lexing");
+    token_buffer.lex_all(lexer, p_job.lexing_thread_count);
+  }
 
+  // Each translation unit has its own context so that they can be compiled
+  // concurrently.
+  PBumpAllocatorOptions allocator_options;
+  allocator_options.use_huge_pages = g_options.opt_huge_pages;
+  PContext context(allocator_options);
+  PParser parser = g_options.opt_prelex ? PParser(context, token_buffer) : PParser(context, lexer);
+
+  PTimeRegion parse_region(P_TIME_GROUP_PHASES, "Parsing and semantic analysis");
   PAstTranslationUnit* ast = parser.parse();
-  ast->dump(context);
+  parse_region.stop();
 
-  if (g_diag_context.diagnostic_count[P_DIAG_ERROR] == 0 && !g_options.opt_syntax_only) {
-    PCodeGenLLVM codegen(context);
-    codegen.codegen(ast->as<PAstTranslationUnit>());
-    fs::create_directory("out");
-    codegen.write_llvm_ir("out/" + p_source_file->get_filename() + ".ir");
-    // codegen.optimize();
-    codegen.write_llvm_ir("out/" + p_source_file->get_filename() + ".opt.ir");
+  if (g_options.opt_dump_ast) {
+    PTimeRegion region(P_TIME_GROUP_PHASES, "AST dump");
+    ast->dump(context, (p_job.dump_output != nullptr) ? p_job.dump_output : stdout);
+  }
 
-    const auto object_path = "out/" + p_source_file->get_filename() + ".o";
-    codegen.write_object_file(object_path);
+  // The code is not generated once another file stopped the compilation.
+  if (g_diag_context.diagnostic_count[P_DIAG_ERROR] == 0 && !g_options.opt_syntax_only &&
+      !diag_is_compilation_stopped())
+    generate_code(context, ast, p_job, p_jit, p_function_cache);
 
-    const auto clang_cmd = fmt::format("clang \"{}\" -o \"{}\"", object_path, p_output_filename);
-    system(clang_cmd.c_str());
-  }
+  // Reported after the code generation, which also allocates in the context
+  // and builds the line maps (lazily, for the debug information).
+  if (g_options.opt_mem_report)
+    report_memory_usage(*p_source_file, identifier_table, token_buffer, context, parser);
 
   return g_diag_context.diagnostic_count[P_DIAG_ERROR] != 0;
 }
 
+/// Runs the given job in the current thread. The diagnostic configuration
+/// of the current thread is set from p_diag_config. If p_cache is not null,
+/// the object file is looked up in and then stored to the cache.
+static void
+run_compile_job(PCompileJob& p_job, const PDiagContext& p_diag_config, PJitLLVM* p_jit, PCompileCache* p_cache)
+{
+  g_diag_context = p_diag_config;
+  for (auto& count : g_diag_context.diagnostic_count)
+    count = 0;
+  g_diag_context.output = p_job.diag_output;
+  g_current_source_file = nullptr;
+
+  auto source_file = PSourceFile::open(p_job.input_file);
+  if (source_file == nullptr) {
+    PDiag* d = diag(P_DK_err_fail_open_file);
+    diag_add_arg_str(d, p_job.input_file.c_str());
+    diag_flush(d);
+  } else if (p_cache == nullptr) {
+    compile_to(source_file.get(), p_job, p_jit, nullptr);
+  } else if (g_options.opt_incremental_codegen && g_options.opt_emit == P_EMIT_EXECUTABLE && !is_lto_enabled()) {
+    // The functions are looked up in the cache once the file is parsed.
+    compile_to(source_file.get(), p_job, p_jit, p_cache);
+  } else {
+    const auto key = p_cache->compute_key(*source_file);
+    if (p_cache->lookup(key, p_job.object.data)) {
+      if (g_options.opt_emit == P_EMIT_OBJECT && !write_object_file(p_job)) {
+        PDiag* d = diag(P_DK_err_fail_open_file);
+        diag_add_arg_str(d, p_job.output_file.c_str());
+        diag_flush(d);
+      }
+    } else {
+      compile_to(source_file.get(), p_job, p_jit, nullptr);
+
+      // Only diagnostic-free compilations are cached, as a cache hit does not
+      // reproduce the diagnostics. No object is generated either when another
+      // file stopped the compilation (-fmax-errors or -Wfatal-errors).
+      bool has_diagnostics = std::any_of(std::begin(g_diag_context.diagnostic_count),
+                                         std::end(g_diag_context.diagnostic_count),
+                                         [](int p_count) { return p_count != 0; });
+      if (!has_diagnostics && !diag_is_compilation_stopped() && !p_job.object.data.empty())
+        p_cache->store(key, p_job.object.data);
+    }
+  }
+
+  g_current_source_file = nullptr;
+  std::copy(std::begin(g_diag_context.diagnostic_count),
+            std::end(g_diag_context.diagnostic_count),
+            std::begin(p_job.diagnostic_count));
+}
+
+/// Compiles all jobs using at most p_thread_count threads. Diagnostics are
+/// reported in the order of the jobs, independently of the scheduling.
+static void
+run_compile_jobs(std::vector<PCompileJob>& p_jobs, unsigned p_thread_count, PJitLLVM* p_jit, PCompileCache* p_cache)
+{
+  const PDiagContext diag_config = g_diag_context;
+
+  if (p_thread_count <= 1 || p_jobs.size() <= 1) {
+    for (auto& job : p_jobs) {
+      if (diag_is_compilation_stopped())
+        break;
+      run_compile_job(job, diag_config, p_jit, p_cache);
+    }
+  } else {
+    for (auto& job : p_jobs) {
+      job.diag_output = tmpfile();
+      if (g_options.opt_dump_ast)
+        job.dump_output = tmpfile();
+    }
+
+    std::atomic<size_t> next_job = 0;
+    auto worker = [&p_jobs, &next_job, &diag_config, p_jit, p_cache]() {
+      size_t job_idx;
+      // No new job is started once -fmax-errors or -Wfatal-errors stopped the
+      // compilation.
+      while (!diag_is_compilation_stopped() && (job_idx = next_job.fetch_add(1)) < p_jobs.size())
+        run_compile_job(p_jobs[job_idx], diag_config, p_jit, p_cache);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < std::min<size_t>(p_thread_count, p_jobs.size()); ++i)
+      threads.emplace_back(worker);
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  // Restore the driver diagnostic state and merge the jobs one.
+  g_diag_context = diag_config;
+  for (auto& job : p_jobs) {
+    if (job.diag_output != nullptr) {
+      diag_print_buffered_output(job.diag_output);
+      fclose(job.diag_output);
+      job.diag_output = nullptr;
+    }
+
+    if (job.dump_output != nullptr) {
+      diag_print_buffered_output(job.dump_output, stdout);
+      fclose(job.dump_output);
+      job.dump_output = nullptr;
+    }
+
+    for (int i = 0; i < P_DIAG_SEVERITY_LAST; ++i)
+      g_diag_context.diagnostic_count[i] += job.diagnostic_count[i];
+  }
+}
+
+/// Links the jobs into the executable p_output_filename. With -flto, the
+/// bitcode of the jobs is first optimized and compiled into native objects.
+static bool
+link_objects(std::vector<PCompileJob>& p_jobs, const char* p_output_filename, unsigned p_thread_count)
+{
+  std::vector<PObjectBuffer> objects;
+  objects.reserve(p_jobs.size());
+  for (auto& job : p_jobs) {
+    // Empty when the functions were compiled separately.
+    if (!job.object.data.empty())
+      objects.push_back(std::move(job.object));
+    for (auto& object : job.function_objects)
+      objects.push_back(std::move(object));
+  }
+
+  if (is_lto_enabled()) {
+    std::vector<PObjectBuffer> bitcodes = std::move(objects);
+    objects.clear();
+
+    PTimeRegion region(P_TIME_GROUP_PHASES, "Link-time optimization");
+    if (!link_time_optimize(g_options.opt_lto, bitcodes, p_thread_count, objects))
+      return false;
+  }
+
+  PTimeRegion region(P_TIME_GROUP_PHASES, "Linking");
+  return link_executable(objects, p_output_filename);
+}
+
+/// Returns the name of the file produced from p_input_file when stopping the
+/// compilation before linking, that is the input file name (in the current
+/// directory) with the extension of the produced artifact.
+static std::string
+get_default_output_file(const std::string& p_input_file)
+{
+  const char* extension = "";
+  switch (g_options.opt_emit) {
+#define EMIT_KIND(p_opt, p_kind, p_extension)                                                                          \
+  case P_EMIT_##p_kind:                                                                                                \
+    extension = p_extension;                                                                                           \
+    break;
+#include "../options.def"
+    default:
+      break;
+  }
+
+  return fs::path(p_input_file).filename().replace_extension(extension).string();
+}
+
+// The compilation cache, if enabled (-fcache-dir). Global so that its
+// statistics can be printed at exit.
+static std::unique_ptr<PCompileCache> g_compile_cache;
+
+/// Returns true if the compilation cache can be used for the current options.
+/// Only object files are cached, and the compilation can not be skipped when
+/// the user asks for the AST or IR.
+static bool
+can_use_compile_cache()
+{
+  return g_options.opt_cache_dir != nullptr && !g_options.opt_syntax_only && !g_options.opt_run &&
+         !g_options.opt_dump_ast && !g_options.opt_dump_ir &&
+         (g_options.opt_emit == P_EMIT_EXECUTABLE || g_options.opt_emit == P_EMIT_OBJECT);
+}
+
 // Implemented in cmdline_parser.c
 void
 cmdline_parser(int p_argc, char* p_argv[]);
@@ -65,18 +472,73 @@ main(int p_argc, char* p_argv[])
   if (g_diag_context.diagnostic_count[P_DIAG_ERROR] > 0)
     return EXIT_FAILURE;
 
-  bool has_error = false;
-  for (const auto& filename : g_options.input_files) {
-    auto source_file = PSourceFile::open(filename);
-    if (source_file == nullptr) {
-      PDiag* d = diag(P_DK_err_fail_open_file);
-      diag_add_arg_str(d, p_argv[1]);
-      diag_flush(d);
+  if (g_options.opt_time_report)
+    atexit([]() { time_report_print(stderr); });
+  if (g_options.opt_mem_report)
+    atexit([]() { mem_report_print(stderr); });
+
+  if (time_trace_enabled()) {
+    atexit([]() {
+      if (!time_trace_write(g_options.opt_time_trace)) {
+        PDiag* d = diag(P_DK_err_fail_open_file);
+        diag_add_arg_str(d, g_options.opt_time_trace);
+        diag_flush(d);
+      }
+    });
+  }
+
+  std::vector<PCompileJob> jobs(g_options.input_files.size());
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    jobs[i].input_file = g_options.input_files[i];
+    jobs[i].object.name = fs::path(jobs[i].input_file).filename().string();
+
+    if (g_options.output_file != nullptr)
+      jobs[i].output_file = g_options.output_file;
+    else
+      jobs[i].output_file = get_default_output_file(jobs[i].input_file);
+  }
+
+  unsigned thread_count = g_options.opt_jobs;
+  if (thread_count == 0)
+    thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+  // The threads not used to compile the files concurrently can lex them.
+  for (auto& job : jobs)
+    job.lexing_thread_count = std::max<unsigned>(thread_count / jobs.size(), 1);
+
+  std::unique_ptr<PJitLLVM> jit;
+  if (g_options.opt_run && !g_options.opt_syntax_only) {
+    jit = std::make_unique<PJitLLVM>();
+    if (!jit->is_valid())
       return EXIT_FAILURE;
-    }
+  }
 
-    has_error |= compile_to(source_file.get(), g_options.output_file);
+  if (can_use_compile_cache()) {
+    const uint64_t max_size = uint64_t(g_options.opt_cache_max_size) * 1024 * 1024;
+    g_compile_cache = std::make_unique<PCompileCache>(g_options.opt_cache_dir, max_size, p_argv[0]);
+    if (g_options.opt_cache_stats)
+      atexit([]() { g_compile_cache->print_stats(stderr); });
   }
 
-  return EXIT_FAILURE ? has_error : EXIT_SUCCESS;
+  run_compile_jobs(jobs, thread_count, jit.get(), g_compile_cache.get());
+  if (g_compile_cache != nullptr)
+    g_compile_cache->trim();
+
+  if (g_diag_context.diagnostic_count[P_DIAG_ERROR] > 0)
+    return EXIT_FAILURE;
+
+  if (jit != nullptr) {
+    int exit_code;
+    // Includes the lazy compilation of the JIT and the execution of main().
+    PTimeRegion region(P_TIME_GROUP_PHASES, "JIT execution");
+    if (!jit->run_main(exit_code))
+      return EXIT_FAILURE;
+    return exit_code;
+  }
+
+  if (!g_options.opt_syntax_only && g_options.opt_emit == P_EMIT_EXECUTABLE &&
+      !link_objects(jobs, g_options.output_file, thread_count))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
 }
@@ -1,7 +1,165 @@
 #include "identifier_table.hxx"
 
+#include <cassert>
 #include <cstring>
 
+PIdentifierInfo*
+PIdentifierInfo::create(PBumpAllocator& p_allocator, std::string_view p_spelling, uint64_t p_hash)
+{
+  auto* identifier = p_allocator.alloc_with_extra_size<PIdentifierInfo>(sizeof(char) * p_spelling.size());
+  identifier->m_hash = p_hash;
+  identifier->m_spelling_len = p_spelling.size();
+  memcpy(identifier->m_spelling, p_spelling.data(), sizeof(char) * p_spelling.size());
+  identifier->m_spelling[p_spelling.size()] = '\0';
+  return identifier;
+}
+
+PIdentifierInfo*
+PConcurrentIdentifierTable::get(std::string_view p_spelling, uint64_t p_hash, PBumpAllocator& p_allocator)
+{
+  assert(p_hash == PIdentifierTable::hash(p_spelling));
+
+  if (PIdentifierInfo* identifier = find(p_spelling, p_hash))
+    return identifier;
+
+  PShard& shard = get_shard(p_hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  // Only the insertions modify the buckets, and they are serialized by the
+  // lock: these (relaxed) loads see the last state of the shard.
+  PBucketArray* buckets = shard.buckets.load(std::memory_order_relaxed);
+  PIdentifierInfo* identifier = nullptr;
+  if (buckets != nullptr) {
+    find_bucket(*buckets, p_spelling, p_hash, identifier);
+    if (identifier != nullptr)
+      return identifier; // inserted by another thread since find()
+  }
+
+  const size_t item_count = shard.item_count.load(std::memory_order_relaxed);
+  if (buckets == nullptr ||
+      static_cast<float>(item_count + 1) > P_MAX_LOAD_FACTOR * static_cast<float>(buckets->bucket_count)) {
+    grow(shard);
+    buckets = shard.buckets.load(std::memory_order_relaxed);
+  }
+
+  PBucket* bucket = find_bucket(*buckets, p_spelling, p_hash, identifier);
+  identifier = PIdentifierInfo::create(p_allocator, p_spelling, p_hash);
+  bucket->hash.store(p_hash, std::memory_order_relaxed);
+  // Publishes the identifier (and the hash) to the concurrent lookups.
+  bucket->identifier.store(identifier, std::memory_order_release);
+  shard.item_count.store(item_count + 1, std::memory_order_relaxed);
+  return identifier;
+}
+
+PIdentifierInfo*
+PConcurrentIdentifierTable::find(std::string_view p_spelling, uint64_t p_hash) const
+{
+  const PBucketArray* buckets = get_shard(p_hash).buckets.load(std::memory_order_acquire);
+  if (buckets == nullptr)
+    return nullptr;
+
+  // The buckets may have been replaced since by a larger array, but this one
+  // is still valid and contains a subset of the identifiers. If p_spelling
+  // was not found, get() checks again with the lock.
+  PIdentifierInfo* identifier;
+  find_bucket(*buckets, p_spelling, p_hash, identifier);
+  return identifier;
+}
+
+PBumpAllocator&
+PConcurrentIdentifierTable::create_allocator()
+{
+  std::lock_guard<std::mutex> lock(m_allocators_mutex);
+  return *m_allocators.emplace_back(std::make_unique<PBumpAllocator>());
+}
+
+size_t
+PConcurrentIdentifierTable::size() const
+{
+  size_t count = 0;
+  for (const auto& shard : m_shards)
+    count += shard.item_count.load(std::memory_order_relaxed);
+  return count;
+}
+
+size_t
+PConcurrentIdentifierTable::get_memory_usage() const
+{
+  size_t bytes = 0;
+  for (const auto& allocator : m_allocators)
+    bytes += allocator->get_reserved_bytes();
+
+  // Including the bucket arrays replaced when the shards grew.
+  for (const auto& shard : m_shards) {
+    for (const auto& buckets : shard.bucket_arrays)
+      bytes += sizeof(PBucketArray) + sizeof(PBucket) * buckets->bucket_count;
+  }
+
+  return bytes;
+}
+
+PConcurrentIdentifierTable::PBucket*
+PConcurrentIdentifierTable::find_bucket(const PBucketArray& p_buckets,
+                                        std::string_view p_spelling,
+                                        uint64_t p_hash,
+                                        PIdentifierInfo*& p_identifier)
+{
+  // Same as PHashMap: the high bits of the hash select the first bucket (the
+  // low ones select the shard).
+  size_t index = static_cast<size_t>(((p_hash >> 32) * p_buckets.bucket_count) >> 32);
+  while (true) {
+    PBucket* bucket = &p_buckets.buckets[index];
+    // The acquire load makes the hash and the identifier stored before it
+    // visible. The bucket is only read once, it may be filled concurrently.
+    p_identifier = bucket->identifier.load(std::memory_order_acquire);
+    if (p_identifier == nullptr)
+      return bucket;
+    if (bucket->hash.load(std::memory_order_relaxed) == p_hash && p_identifier->get_spelling() == p_spelling)
+      return bucket;
+
+    if (++index == p_buckets.bucket_count)
+      index = 0;
+  }
+}
+
+void
+PConcurrentIdentifierTable::grow(PShard& p_shard)
+{
+  const PBucketArray* old_buckets = p_shard.buckets.load(std::memory_order_relaxed);
+  const size_t old_bucket_count = (old_buckets != nullptr) ? old_buckets->bucket_count : 0;
+
+  auto new_buckets = std::make_unique<PBucketArray>();
+  new_buckets->bucket_count = p_get_new_hash_table_size(old_bucket_count);
+  assert(new_buckets->bucket_count <= UINT32_MAX && "see find_bucket()");
+  new_buckets->buckets = std::make_unique<PBucket[]>(new_buckets->bucket_count);
+
+  // The new array is not published yet, relaxed stores are enough.
+  for (size_t i = 0; i < old_bucket_count; ++i) {
+    const PBucket& old_bucket = old_buckets->buckets[i];
+    PIdentifierInfo* identifier = old_bucket.identifier.load(std::memory_order_relaxed);
+    if (identifier == nullptr)
+      continue;
+
+    const uint64_t hash = old_bucket.hash.load(std::memory_order_relaxed);
+    PIdentifierInfo* existing_identifier;
+    PBucket* bucket = find_bucket(*new_buckets, identifier->get_spelling(), hash, existing_identifier);
+    assert(existing_identifier == nullptr);
+    bucket->hash.store(hash, std::memory_order_relaxed);
+    bucket->identifier.store(identifier, std::memory_order_relaxed);
+  }
+
+  // The previous arrays are kept alive for the concurrent lookups.
+  p_shard.buckets.store(new_buckets.get(), std::memory_order_release);
+  p_shard.bucket_arrays.push_back(std::move(new_buckets));
+}
+
+PIdentifierTable::PIdentifierTable(PConcurrentIdentifierTable* p_shared_table)
+  : m_shared_table(p_shared_table)
+{
+  if (m_shared_table != nullptr)
+    m_allocator = &m_shared_table->create_allocator();
+}
+
 PIdentifierInfo*
 PIdentifierTable::get(const char* p_spelling_begin, const char* p_spelling_end)
 {
@@ -15,26 +173,15 @@ PIdentifierTable::get(const char* p_spelling_begin, const char* p_spelling_end)
 }
 
 PIdentifierInfo*
-PIdentifierTable::get(std::string_view p_spelling)
+PIdentifierTable::get(std::string_view p_spelling, uint64_t p_hash)
 {
-  const auto it = m_mapping.find(p_spelling);
-  if (it != m_mapping.end())
-    return it->second;
-
-  auto* identifier = m_allocator.alloc_with_extra_size<PIdentifierInfo>(sizeof(char) * p_spelling.size());
-  identifier->set_token_kind(P_TOK_IDENTIFIER);
-  identifier->m_spelling_len = p_spelling.size();
-  memcpy(identifier->m_spelling, p_spelling.data(), sizeof(char) * p_spelling.size());
-  identifier->m_spelling[p_spelling.size()] = '\0';
+  assert(p_hash == hash(p_spelling));
 
-  m_mapping.insert({ identifier->get_spelling(), identifier });
-  return identifier;
-}
+  const auto result = m_identifiers.lazy_emplace(p_spelling, p_hash, [&]() {
+    if (m_shared_table != nullptr)
+      return m_shared_table->get(p_spelling, p_hash, *m_allocator);
+    return PIdentifierInfo::create(*m_allocator, p_spelling, p_hash);
+  });
 
-void
-PIdentifierTable::register_keywords()
-{
-#define TOKEN(p_kind)
-#define KEYWORD(p_spelling) get(#p_spelling)->set_token_kind(P_TOK_KEY_##p_spelling);
-#include "token_kind.def"
+  return *result.first;
 }
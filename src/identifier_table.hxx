@@ -3,12 +3,21 @@
 
 #include "token_kind.hxx"
 #include "utils/bump_allocator.hxx"
+#include "utils/hash_map.hxx"
 #include "utils/source_location.hxx"
 
+#include <atomic>
 #include <cstddef>
-#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
 
-/// \brief Represents an identifier or a keyword in the source code.
+/// \brief Represents an identifier in the source code.
+///
+/// Keywords are not identifiers, they are recognized by the lexer using
+/// token_kind_get_keyword().
 ///
 /// Two semantically equivalent identifiers are stored at the same address.
 /// Therefore, comparing if two identifiers are equivalent is the same as
@@ -18,14 +27,19 @@ class PIdentifierInfo
 public:
   /// Returns the UTF-8 encoded spelling of the identifier.
   [[nodiscard]] std::string_view get_spelling() const { return { m_spelling, m_spelling_len }; }
-
-  /// Returns the token kind associated to this identifier. Either IDENTIFIER or a keyword.
-  [[nodiscard]] PTokenKind get_token_kind() const { return m_token_kind; }
-  void set_token_kind(PTokenKind kind) { m_token_kind = kind; }
+  /// Returns the hash of the spelling, as computed by PIdentifierTable::hash().
+  [[nodiscard]] uint64_t get_hash() const { return m_hash; }
 
 private:
   friend class PIdentifierTable;
-  PTokenKind m_token_kind;
+  friend class PConcurrentIdentifierTable;
+
+  /// Allocates a new identifier in p_allocator.
+  [[nodiscard]] static PIdentifierInfo* create(PBumpAllocator& p_allocator,
+                                               std::string_view p_spelling,
+                                               uint64_t p_hash);
+
+  uint64_t m_hash;
   size_t m_spelling_len;
   char m_spelling[1];
 };
@@ -37,18 +51,157 @@ struct PLocalizedIdentifierInfo
   PSourceRange range;
 };
 
+/// \brief A thread-safe hash table of identifiers, shared by the identifier
+/// tables of several threads (e.g. concurrent lexers) so that the identifiers
+/// remain unique across all of them.
+///
+/// The table is split into shards, selected by the hash of the spelling, each
+/// one being an insert-only open-addressing table. Looking up an existing
+/// identifier is wait-free: it only reads the buckets with atomic loads. Only
+/// the insertions lock the mutex of their shard. When a shard grows, its
+/// buckets are copied in a new array which is then published; the previous
+/// arrays are still read by concurrent lookups and are only freed with the
+/// table.
+///
+/// The identifiers are allocated in an allocator given by the caller,
+/// typically one per thread created with create_allocator(), rather than in a
+/// single allocator shared by all the threads.
+class PConcurrentIdentifierTable
+{
+public:
+  PConcurrentIdentifierTable() = default;
+
+  PConcurrentIdentifierTable(const PConcurrentIdentifierTable&) = delete;
+  PConcurrentIdentifierTable& operator=(const PConcurrentIdentifierTable&) = delete;
+
+  /// Returns the identifier p_spelling, whose hash is p_hash (see
+  /// PIdentifierTable::hash()). If it is not in the table yet, it is
+  /// allocated in p_allocator and inserted. Thread-safe.
+  [[nodiscard]] PIdentifierInfo* get(std::string_view p_spelling, uint64_t p_hash, PBumpAllocator& p_allocator);
+  /// Returns the identifier p_spelling or nullptr if it is not in the table.
+  /// Thread-safe and wait-free.
+  [[nodiscard]] PIdentifierInfo* find(std::string_view p_spelling, uint64_t p_hash) const;
+
+  /// Returns a new allocator for the identifiers inserted by one thread. It
+  /// lives as long as the table. Thread-safe.
+  [[nodiscard]] PBumpAllocator& create_allocator();
+
+  /// Returns the count of identifiers in the table.
+  [[nodiscard]] size_t size() const;
+  /// Returns the count of bytes allocated for the identifiers and the buckets.
+  /// Must not be called concurrently with get().
+  [[nodiscard]] size_t get_memory_usage() const;
+
+private:
+  static constexpr size_t SHARD_COUNT = 64;
+
+  struct PBucket
+  {
+    std::atomic<uint64_t> hash;
+    std::atomic<PIdentifierInfo*> identifier; // nullptr if the bucket is empty
+  };
+
+  struct PBucketArray
+  {
+    size_t bucket_count;
+    std::unique_ptr<PBucket[]> buckets;
+  };
+
+  // Aligned to avoid false sharing between the shards.
+  struct alignas(64) PShard
+  {
+    std::atomic<PBucketArray*> buckets = nullptr;
+    std::atomic<size_t> item_count = 0;
+    // Locked by the insertions only.
+    std::mutex mutex;
+    // The current bucket array, and all the previous ones.
+    std::vector<std::unique_ptr<PBucketArray>> bucket_arrays;
+  };
+
+  [[nodiscard]] PShard& get_shard(uint64_t p_hash) { return m_shards[p_hash % SHARD_COUNT]; }
+  [[nodiscard]] const PShard& get_shard(uint64_t p_hash) const { return m_shards[p_hash % SHARD_COUNT]; }
+  /// Returns the bucket of p_spelling in p_buckets, or the empty bucket where
+  /// to insert it. p_identifier is set to the identifier read in the bucket,
+  /// nullptr if it was empty.
+  static PBucket* find_bucket(const PBucketArray& p_buckets,
+                              std::string_view p_spelling,
+                              uint64_t p_hash,
+                              PIdentifierInfo*& p_identifier);
+  /// Replaces the buckets of p_shard by a larger array. The shard must be
+  /// locked.
+  static void grow(PShard& p_shard);
+
+  PShard m_shards[SHARD_COUNT];
+
+  std::mutex m_allocators_mutex;
+  std::vector<std::unique_ptr<PBumpAllocator>> m_allocators;
+};
+
 /// \brief A dynamic hash table optimized for storing identifiers.
+///
+/// This is a PHashSet of the identifiers, looked up by spelling. The hash of
+/// each identifier is stored in it, so the table never hashes the spellings
+/// again when it grows.
+///
+/// The table is not thread-safe. To share the identifiers between several
+/// threads, each thread uses its own PIdentifierTable created with the same
+/// PConcurrentIdentifierTable. The identifiers are then owned by the shared
+/// table, and the PIdentifierTable only caches the ones it already got.
 class PIdentifierTable
 {
 public:
+  PIdentifierTable() = default;
+  /// Creates a table that gets its identifiers from p_shared_table (if not
+  /// nullptr), which must outlive it.
+  explicit PIdentifierTable(PConcurrentIdentifierTable* p_shared_table);
+
+  PIdentifierTable(const PIdentifierTable&) = delete;
+  PIdentifierTable& operator=(const PIdentifierTable&) = delete;
+
   [[nodiscard]] PIdentifierInfo* get(const char* p_spelling_begin, const char* p_spelling_end);
-  [[nodiscard]] PIdentifierInfo* get(std::string_view p_spelling);
+  [[nodiscard]] PIdentifierInfo* get(std::string_view p_spelling) { return get(p_spelling, hash(p_spelling)); }
+  /// Same as get(p_spelling) but with p_hash, the result of hash(p_spelling),
+  /// already computed (e.g. by the lexer).
+  [[nodiscard]] PIdentifierInfo* get(std::string_view p_spelling, uint64_t p_hash);
+
+  /// Returns the hash of p_spelling used by the table.
+  [[nodiscard]] static uint64_t hash(std::string_view p_spelling) { return p_hash_string(p_spelling); }
 
-  void register_keywords();
+  /// Returns the shared table this table gets its identifiers from, if any.
+  [[nodiscard]] PConcurrentIdentifierTable* get_shared_table() const { return m_shared_table; }
+
+  /// Returns the count of identifiers in the table (only the ones already
+  /// got by this table if it has a shared table).
+  [[nodiscard]] size_t size() const { return m_identifiers.size(); }
+  /// Returns the count of bytes allocated for the identifiers and the buckets,
+  /// without the ones of the shared table.
+  [[nodiscard]] size_t get_memory_usage() const
+  {
+    return m_own_allocator.get_reserved_bytes() + m_identifiers.get_memory_usage();
+  }
 
 private:
-  PBumpAllocator m_allocator;
-  std::unordered_map<std::string_view, PIdentifierInfo*> m_mapping;
+  struct PIdentifierHash
+  {
+    [[nodiscard]] uint64_t operator()(const PIdentifierInfo* p_identifier) const noexcept
+    {
+      return p_identifier->get_hash();
+    }
+  };
+
+  struct PIdentifierEqual
+  {
+    [[nodiscard]] bool operator()(const PIdentifierInfo* p_identifier, std::string_view p_spelling) const noexcept
+    {
+      return p_identifier->get_spelling() == p_spelling;
+    }
+  };
+
+  PConcurrentIdentifierTable* m_shared_table = nullptr;
+  PBumpAllocator m_own_allocator;
+  // Either m_own_allocator or an allocator of m_shared_table.
+  PBumpAllocator* m_allocator = &m_own_allocator;
+  PHashSet<PIdentifierInfo*, PIdentifierHash, PIdentifierEqual> m_identifiers;
 };
 
 #endif // PEONY_IDENTIFIER_TABLE_HXX
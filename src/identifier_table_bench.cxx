@@ -0,0 +1,136 @@
+#include "identifier_table.hxx"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// The previous implementation of PIdentifierTable, used as a baseline: a
+/// std::unordered_map from the spellings to bump allocated identifiers.
+class PBaselineIdentifierTable
+{
+public:
+  struct PInfo
+  {
+    size_t spelling_len;
+    char spelling[1];
+  };
+
+  PInfo* get(std::string_view p_spelling)
+  {
+    const auto it = m_mapping.find(p_spelling);
+    if (it != m_mapping.end())
+      return it->second;
+
+    auto* identifier = m_allocator.alloc_with_extra_size<PInfo>(p_spelling.size());
+    identifier->spelling_len = p_spelling.size();
+    memcpy(identifier->spelling, p_spelling.data(), p_spelling.size());
+    identifier->spelling[p_spelling.size()] = '\0';
+
+    m_mapping.insert({ { identifier->spelling, p_spelling.size() }, identifier });
+    return identifier;
+  }
+
+private:
+  PBumpAllocator m_allocator;
+  std::unordered_map<std::string_view, PInfo*> m_mapping;
+};
+
+/// Returns p_count distinct identifiers, 1 to 16 characters long.
+static std::vector<std::string>
+generate_identifiers(size_t p_count)
+{
+  static const char g_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+  std::mt19937_64 rng(42);
+  std::vector<std::string> identifiers;
+  identifiers.reserve(p_count);
+  for (size_t i = 0; i < p_count; ++i) {
+    std::string identifier(1 + rng() % 16, 'a');
+    for (char& c : identifier)
+      c = g_chars[rng() % (sizeof(g_chars) - 11)]; // no leading digit
+    identifier += std::to_string(i); // make it unique
+    identifiers.push_back(std::move(identifier));
+  }
+
+  return identifiers;
+}
+
+/// Returns p_count identifiers picked among p_identifiers, as in a source
+/// file where a few identifiers are used much more often than the others.
+static std::vector<std::string_view>
+generate_lookups(const std::vector<std::string>& p_identifiers, size_t p_count)
+{
+  std::mt19937_64 rng(43);
+  std::geometric_distribution<size_t> distribution(0.01);
+
+  std::vector<std::string_view> lookups;
+  lookups.reserve(p_count);
+  for (size_t i = 0; i < p_count; ++i)
+    lookups.push_back(p_identifiers[distribution(rng) % p_identifiers.size()]);
+  return lookups;
+}
+
+template<class Table>
+static void
+run_insert_benchmark(benchmark::State& p_state)
+{
+  const auto identifiers = generate_identifiers(p_state.range(0));
+  for (auto _ : p_state) {
+    Table table;
+    for (const auto& identifier : identifiers)
+      benchmark::DoNotOptimize(table.get(identifier));
+  }
+
+  p_state.SetItemsProcessed(p_state.iterations() * identifiers.size());
+}
+
+template<class Table>
+static void
+run_lookup_benchmark(benchmark::State& p_state)
+{
+  const auto identifiers = generate_identifiers(p_state.range(0));
+  const auto lookups = generate_lookups(identifiers, 100000);
+
+  Table table;
+  for (const auto& identifier : identifiers)
+    benchmark::DoNotOptimize(table.get(identifier));
+
+  for (auto _ : p_state) {
+    for (const auto& lookup : lookups)
+      benchmark::DoNotOptimize(table.get(lookup));
+  }
+
+  p_state.SetItemsProcessed(p_state.iterations() * lookups.size());
+}
+
+static void
+BM_identifier_table_insert(benchmark::State& p_state)
+{
+  run_insert_benchmark<PIdentifierTable>(p_state);
+}
+BENCHMARK(BM_identifier_table_insert)->Arg(1000)->Arg(100000);
+
+static void
+BM_identifier_table_insert_baseline(benchmark::State& p_state)
+{
+  run_insert_benchmark<PBaselineIdentifierTable>(p_state);
+}
+BENCHMARK(BM_identifier_table_insert_baseline)->Arg(1000)->Arg(100000);
+
+static void
+BM_identifier_table_lookup(benchmark::State& p_state)
+{
+  run_lookup_benchmark<PIdentifierTable>(p_state);
+}
+BENCHMARK(BM_identifier_table_lookup)->Arg(1000)->Arg(100000);
+
+static void
+BM_identifier_table_lookup_baseline(benchmark::State& p_state)
+{
+  run_lookup_benchmark<PBaselineIdentifierTable>(p_state);
+}
+BENCHMARK(BM_identifier_table_lookup_baseline)->Arg(1000)->Arg(100000);
@@ -1,7 +1,12 @@
 #include "identifier_table.hxx"
+#include "lexer.hxx"
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <thread>
+#include <vector>
+
 TEST(identifier_table, get_not_exists)
 {
   PIdentifierTable table;
@@ -12,11 +17,9 @@ TEST(identifier_table, get_not_exists)
   PIdentifierInfo* ident2 = table.get(spelling, spelling + 3);
 
   ASSERT_NE(ident1, nullptr);
-  EXPECT_EQ(ident1->get_token_kind(), P_TOK_IDENTIFIER);
   EXPECT_EQ(ident1->get_spelling(), "foo");
 
   ASSERT_NE(ident2, nullptr);
-  EXPECT_EQ(ident2->get_token_kind(), P_TOK_IDENTIFIER);
   EXPECT_EQ(ident2->get_spelling(), "bar");
 }
 
@@ -52,16 +55,120 @@ TEST(identifier_table, many_gets)
   EXPECT_EQ(foo->get_spelling(), "foo");
 }
 
-TEST(identifier_table, keywords)
+TEST(identifier_table, precomputed_hash)
+{
+  PIdentifierTable table;
+
+  const std::string_view spelling = "a_longer_identifier";
+  const uint64_t hash = PIdentifierTable::hash(spelling);
+  PIdentifierInfo* ident = table.get(spelling, hash);
+  ASSERT_NE(ident, nullptr);
+  EXPECT_EQ(ident->get_hash(), hash);
+  EXPECT_EQ(ident->get_spelling(), spelling);
+  EXPECT_EQ(table.get(spelling), ident);
+}
+
+TEST(identifier_table, grow)
 {
   PIdentifierTable table;
 
-  PIdentifierInfo* i32_key = table.get("i32", nullptr);
-  EXPECT_EQ(i32_key->get_token_kind(), P_TOK_IDENTIFIER);
+  std::vector<PIdentifierInfo*> identifiers;
+  for (int i = 0; i < 10000; ++i)
+    identifiers.push_back(table.get("ident_" + std::to_string(i)));
+  EXPECT_EQ(table.size(), identifiers.size());
+
+  for (int i = 0; i < 10000; ++i) {
+    const auto spelling = "ident_" + std::to_string(i);
+    EXPECT_EQ(table.get(spelling), identifiers[i]);
+    EXPECT_EQ(identifiers[i]->get_spelling(), spelling);
+  }
+  EXPECT_EQ(table.size(), identifiers.size());
+}
+
+TEST(concurrent_identifier_table, shared_identifiers)
+{
+  PConcurrentIdentifierTable shared_table;
+  PIdentifierTable table1(&shared_table);
+  PIdentifierTable table2(&shared_table);
+  EXPECT_EQ(table1.get_shared_table(), &shared_table);
+
+  PIdentifierInfo* foo = table1.get("foo");
+  EXPECT_EQ(foo->get_spelling(), "foo");
+  EXPECT_EQ(table2.get("foo"), foo);
+  EXPECT_EQ(shared_table.find("foo", PIdentifierTable::hash("foo")), foo);
+  EXPECT_EQ(shared_table.find("bar", PIdentifierTable::hash("bar")), nullptr);
+  EXPECT_EQ(shared_table.size(), 1);
+
+  // Tables without a shared table have their own identifiers.
+  PIdentifierTable table3;
+  EXPECT_EQ(table3.get_shared_table(), nullptr);
+  EXPECT_NE(table3.get("foo"), foo);
+}
+
+TEST(concurrent_identifier_table, concurrent_gets)
+{
+  constexpr int thread_count = 8;
+  constexpr int identifier_count = 20000;
+
+  PConcurrentIdentifierTable shared_table;
+  std::vector<std::vector<PIdentifierInfo*>> identifiers(thread_count);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&shared_table, &result = identifiers[t], t] {
+      PIdentifierTable table(&shared_table);
+      result.resize(identifier_count);
+      // Each thread inserts the identifiers in its own order, so that they
+      // race to insert each of them while the shards grow.
+      for (int i = 0; i < identifier_count; ++i) {
+        const int index = (((t % 2 == 0) ? i : identifier_count - 1 - i) + t * 2503) % identifier_count;
+        result[index] = table.get("ident_" + std::to_string(index));
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(shared_table.size(), identifier_count);
+  for (int i = 0; i < identifier_count; ++i) {
+    ASSERT_EQ(identifiers[0][i]->get_spelling(), "ident_" + std::to_string(i));
+    for (int t = 1; t < thread_count; ++t)
+      ASSERT_EQ(identifiers[t][i], identifiers[0][i]);
+  }
+}
+
+TEST(concurrent_identifier_table, concurrent_lexers)
+{
+  constexpr int thread_count = 8;
+
+  std::string input;
+  for (int i = 0; i < 2000; ++i)
+    input += "fn h" + std::to_string(i) + "(x" + std::to_string(i % 100) + ": i32) -> i32 { return g(x); }\n";
+  PSourceFile source_file("<test-input>", input);
+
+  PConcurrentIdentifierTable shared_table;
+  std::vector<std::vector<PIdentifierInfo*>> identifiers(thread_count);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&shared_table, &source_file, &result = identifiers[t]] {
+      PIdentifierTable table(&shared_table);
+      PLexer lexer;
+      lexer.identifier_table = &table;
+      lexer.set_source_file(&source_file);
+
+      PToken token;
+      do {
+        lexer.tokenize(token);
+        if (token.kind == P_TOK_IDENTIFIER)
+          result.push_back(token.data.identifier);
+      } while (token.kind != P_TOK_EOF);
+    });
+  }
 
-  table.register_keywords();
-  EXPECT_EQ(i32_key->get_token_kind(), P_TOK_KEY_i32);
+  for (auto& thread : threads)
+    thread.join();
 
-  PIdentifierInfo* true_key = table.get("true", nullptr);
-  EXPECT_EQ(true_key->get_token_kind(), P_TOK_KEY_true);
+  EXPECT_EQ(shared_table.size(), 2000 + 100 + 2);
+  for (int t = 1; t < thread_count; ++t)
+    EXPECT_EQ(identifiers[t], identifiers[0]);
 }
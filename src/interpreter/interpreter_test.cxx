@@ -7,7 +7,7 @@
 class InterpreterTest : public ::testing::Test
 {
 public:
-  PContext& ctx = PContext::get_global();
+  PContext ctx;
   PIdentifierTable identifier_table;
   PLexer lexer;
   std::unique_ptr<PParser> parser;
@@ -15,7 +15,6 @@ public:
 
   void SetUp() override
   {
-    identifier_table.register_keywords();
     lexer.identifier_table = &identifier_table;
 
     parser = std::make_unique<PParser>(ctx, lexer);
@@ -80,7 +79,7 @@ TEST_F(InterpreterTest, int_literal)
 TEST_F(InterpreterTest, float_literal)
 {
   check_expr("0.0", PInterpreterValue::make_float(0.0));
-  check_expr("1.2f32", PInterpreterValue::make_float(1.2));
+  check_expr("1.2f32", PInterpreterValue::make_float(1.2f)); // rounded to f32
   check_expr("5.2f64", PInterpreterValue::make_float(5.2));
 }
 
@@ -0,0 +1,92 @@
+#include "jit_llvm.hxx"
+
+#include "codegen_llvm.hxx"
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+struct PJitLLVM::D
+{
+  std::unique_ptr<llvm::orc::LLJIT> jit;
+};
+
+PJitLLVM::PJitLLVM()
+  : m_d(new D)
+{
+  auto jit = llvm::orc::LLJITBuilder().create();
+  if (!jit) {
+    llvm::errs() << "Could not create the JIT: " << llvm::toString(jit.takeError()) << "\n";
+    return;
+  }
+
+  m_d->jit = std::move(*jit);
+
+  // Resolve the symbols not defined by the Peony modules (e.g. `abort` or
+  // extern functions from the C library) from the current process.
+  auto generator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+    m_d->jit->getDataLayout().getGlobalPrefix());
+  if (!generator) {
+    llvm::errs() << "Could not create the JIT symbol generator: " << llvm::toString(generator.takeError()) << "\n";
+    m_d->jit.reset();
+    return;
+  }
+
+  m_d->jit->getMainJITDylib().addGenerator(std::move(*generator));
+}
+
+PJitLLVM::~PJitLLVM() = default;
+
+bool
+PJitLLVM::is_valid() const
+{
+  return m_d->jit != nullptr;
+}
+
+bool
+PJitLLVM::add_module(PCodeGenLLVM& p_codegen, std::string& p_error_message)
+{
+  assert(is_valid());
+
+  std::unique_ptr<llvm::Module> module;
+  std::unique_ptr<llvm::LLVMContext> context;
+  p_codegen.release_module(module, context);
+
+  auto error = m_d->jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+  if (error) {
+    p_error_message = llvm::toString(std::move(error));
+    return false;
+  }
+
+  return true;
+}
+
+bool
+PJitLLVM::run_main(int& p_exit_code)
+{
+  assert(is_valid());
+
+  auto main_symbol = m_d->jit->lookup("main");
+  if (!main_symbol) {
+    llvm::errs() << "Could not find the `main` function: " << llvm::toString(main_symbol.takeError()) << "\n";
+    return false;
+  }
+
+  // Run the static constructors (if any) before main.
+  if (auto error = m_d->jit->initialize(m_d->jit->getMainJITDylib())) {
+    llvm::errs() << llvm::toString(std::move(error)) << "\n";
+    return false;
+  }
+
+  auto* main_fn = main_symbol->toPtr<int (*)()>();
+  p_exit_code = main_fn();
+
+  if (auto error = m_d->jit->deinitialize(m_d->jit->getMainJITDylib())) {
+    llvm::errs() << llvm::toString(std::move(error)) << "\n";
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,36 @@
+#ifndef PEONY_JIT_LLVM_HXX
+#define PEONY_JIT_LLVM_HXX
+
+#include <memory>
+#include <string>
+
+class PCodeGenLLVM;
+
+/// Executes in-process the code generated by PCodeGenLLVM using the LLVM ORC JIT.
+///
+/// This avoids writing object files to disk and spawning a linker, which
+/// dominates the turnaround for small programs.
+class PJitLLVM
+{
+public:
+  PJitLLVM();
+  ~PJitLLVM();
+
+  /// Returns true if the JIT was successfully initialized for the host.
+  [[nodiscard]] bool is_valid() const;
+
+  /// Moves the module generated by p_codegen into the JIT. The code generator
+  /// can not be used anymore after this call. This function is thread-safe.
+  /// On failure, returns false and stores the reason into p_error_message.
+  [[nodiscard]] bool add_module(PCodeGenLLVM& p_codegen, std::string& p_error_message);
+
+  /// Compiles and runs the `main` function returning its exit code into
+  /// p_exit_code. Returns false if `main` could not be found or compiled.
+  bool run_main(int& p_exit_code);
+
+private:
+  struct D;
+  std::unique_ptr<D> m_d;
+};
+
+#endif // PEONY_JIT_LLVM_HXX
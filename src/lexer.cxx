@@ -1,5 +1,7 @@
 #include "lexer.hxx"
 
+#include "literal_parser.hxx"
+#include "utils/char_scan.hxx"
 #include "utils/diag.hxx"
 
 #include <cassert>
@@ -18,30 +20,194 @@ PLexer::set_source_file(PSourceFile* p_source_file)
 
   source_file = p_source_file;
   m_cursor = source_file->get_buffer_raw();
+  m_end = m_cursor + source_file->get_buffer().size();
 }
 
 void
-PLexer::fill_token(PToken& p_token, PTokenKind p_kind)
+PLexer::set_source_range(uint32_t p_begin, uint32_t p_end)
 {
-  p_token.kind = p_kind;
-  p_token.source_location = m_marked_source_location;
-  p_token.token_length = m_cursor - m_marked_cursor;
+  assert(source_file != nullptr);
+  assert(p_begin <= p_end && p_end <= source_file->get_buffer().size());
+
+  m_cursor = source_file->get_buffer_raw() + p_begin;
+  m_end = source_file->get_buffer_raw() + p_end;
 }
 
 void
-PLexer::register_newline()
+PLexer::report_unknown_character(PSourceLocation p_location)
 {
-  uint32_t line_pos = m_cursor - source_file->get_buffer_raw();
-  source_file->get_line_map().add(line_pos);
+  assert(g_current_source_file != nullptr);
+
+  PDiag* d = diag_at(P_DK_err_unknown_character, p_location);
+  diag_add_arg_char(d, g_current_source_file->get_buffer_raw()[p_location]);
+  diag_flush(d);
+}
+
+void
+PLexer::handle_unknown_character()
+{
+  if (m_deferred_diagnostics != nullptr)
+    m_deferred_diagnostics->push_back(m_marked_source_location);
+  else
+    report_unknown_character(m_marked_source_location);
+}
+
+/// Returns the end of the string literal starting at p_begin (a `"`) as
+/// matched by the str_literal rule of the lexer, or nullptr if the rule does
+/// not match (then the quote is lexed as an unknown character).
+static const char*
+match_string_literal(const char* p_begin, const char* p_end)
+{
+  auto is_hex_digit = [](char p_c) {
+    return (p_c >= '0' && p_c <= '9') || (p_c >= 'a' && p_c <= 'f') || (p_c >= 'A' && p_c <= 'F');
+  };
+
+  assert(*p_begin == '"');
+  const char* it = p_begin + 1;
+  while (it != p_end) {
+    switch (*it++) {
+      case '"':
+        return it;
+      case '\n':
+      case '\r':
+      case '\0':
+        return nullptr;
+      case '\\':
+        if (it == p_end)
+          return nullptr;
+
+        switch (*it++) {
+          case '\'':
+          case '"':
+          case 'n':
+          case 'r':
+          case 't':
+          case '0':
+          case '\\':
+            break;
+          case 'x':
+            if (p_end - it < 2 || it[0] < '0' || it[0] > '7' || !is_hex_digit(it[1]))
+              return nullptr;
+            it += 2;
+            break;
+          case 'u': {
+            if (it == p_end || *it++ != '{')
+              return nullptr;
+
+            // (hex_digit digit_sep*){1,6} "}"
+            int digit_count = 0;
+            while (it != p_end && is_hex_digit(*it)) {
+              if (++digit_count > 6)
+                return nullptr;
+              ++it;
+              while (it != p_end && *it == '_')
+                ++it;
+            }
+
+            if (digit_count == 0 || it == p_end || *it++ != '}')
+              return nullptr;
+            break;
+          }
+          default:
+            return nullptr;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  return nullptr;
+}
+
+std::vector<uint32_t>
+PLexer::find_split_points(std::string_view p_buffer, unsigned p_count)
+{
+  std::vector<uint32_t> split_points;
+  if (p_count <= 1)
+    return split_points;
+
+  const char* begin = p_buffer.data();
+  const char* end = begin + p_buffer.size();
+  const char* next_split_target = begin + p_buffer.size() / p_count;
+
+  // Only the comments and the string literals can contain a newline or the
+  // start of a block comment that is not one. A NUL character ends the lexing
+  // (no split point after it).
+  const char* it = begin;
+  while (it != end) {
+    if (it < next_split_target) {
+      // The newlines before the target are not split points.
+      it = p_find_any_of(it, next_split_target, std::string_view("/\"\0", 3));
+      if (it == next_split_target)
+        continue;
+    } else {
+      it = p_find_any_of(it, end, std::string_view("/\"\n\0", 4));
+    }
+
+    if (it == end || *it == '\0')
+      break;
+
+    if (*it == '\n') {
+      ++it;
+      if (it == end)
+        break;
+
+      split_points.push_back(static_cast<uint32_t>(it - begin));
+      if (split_points.size() == p_count - 1)
+        break;
+      next_split_target = begin + p_buffer.size() * (split_points.size() + 1) / p_count;
+    } else if (*it == '"') {
+      const char* literal_end = match_string_literal(it, end);
+      it = (literal_end != nullptr) ? literal_end : it + 1;
+    } else if (it + 1 != end && it[1] == '/') {
+      it = p_find_line_end(it + 2, end);
+    } else if (it + 1 != end && it[1] == '*') {
+      // Like the lexer, the block comment ends at the first "*/".
+      it += 2;
+      for (;;) {
+        it = p_find_any_of(it, end, std::string_view("*\0", 2));
+        if (it == end || *it == '\0')
+          return split_points; // unterminated block comment
+        ++it;
+        if (it != end && *it == '/') {
+          ++it;
+          break;
+        }
+      }
+    } else {
+      ++it;
+    }
+  }
+
+  return split_points;
+}
+
+void
+PLexer::fill_token(PToken& p_token, PTokenKind p_kind)
+{
+  p_token.kind = p_kind;
+  p_token.source_location = m_marked_source_location;
+  p_token.token_length = m_cursor - m_marked_cursor;
 }
 
 void
 PLexer::fill_identifier_token(PToken& p_token, bool p_is_raw)
 {
+  if (!p_is_raw) {
+    const PTokenKind keyword = token_kind_get_keyword({ m_marked_cursor, size_t(m_cursor - m_marked_cursor) });
+    if (keyword != P_TOK_IDENTIFIER) {
+      fill_token(p_token, keyword);
+      return;
+    }
+  }
+
   const char* spelling_begin = p_is_raw ? m_marked_cursor + 2 : m_marked_cursor;
-  PIdentifierInfo* ident = identifier_table->get(spelling_begin, m_cursor);
+  const std::string_view spelling(spelling_begin, m_cursor - spelling_begin);
+  // The spelling was just scanned and is still in cache, hash it right away.
+  PIdentifierInfo* ident = identifier_table->get(spelling, PIdentifierTable::hash(spelling));
   assert(ident != nullptr);
-  fill_token(p_token, p_is_raw ? P_TOK_IDENTIFIER : ident->get_token_kind());
+  fill_token(p_token, P_TOK_IDENTIFIER);
   p_token.data.identifier = ident;
 }
 
@@ -104,6 +270,13 @@ PLexer::fill_integer_literal(PToken& p_token, int p_radix)
   p_token.data.literal.begin = m_marked_cursor;
   p_token.data.literal.end = m_cursor; // suffix is removed in parse_int_suffix().
   parse_int_suffix(p_token);
+
+  // Compute the value now rather than in the parser, while the literal is
+  // still in cache.
+  uintmax_t value;
+  p_token.data.literal.int_overflow =
+    parse_int_literal_token(p_token.data.literal.begin, p_token.data.literal.end, p_radix, value);
+  p_token.data.literal.int_value = value;
 }
 
 void
@@ -5,6 +5,9 @@
 #include "token.hxx"
 #include "utils/source_file.hxx"
 
+#include <string_view>
+#include <vector>
+
 /// The lexical analyzer interface.
 class PLexer
 {
@@ -15,6 +18,24 @@ public:
   PSourceFile* source_file;
 
   void set_source_file(PSourceFile* p_source_file);
+  /// Only lexes the bytes [p_begin, p_end) of the source file: P_TOK_EOF is
+  /// returned at p_end. The range must start and end at split points (see
+  /// find_split_points()) or at the start and end of the file.
+  void set_source_range(uint32_t p_begin, uint32_t p_end);
+
+  /// Defers the diagnostics of the lexer: instead of being reported, the
+  /// location of unknown characters are appended to p_locations (nullptr
+  /// reports them again). Used to report diagnostics of lexers run by other
+  /// threads in order, with report_unknown_character().
+  void set_deferred_diagnostics(std::vector<PSourceLocation>* p_locations) { m_deferred_diagnostics = p_locations; }
+  /// Reports the unknown character at p_location of the current source file.
+  static void report_unknown_character(PSourceLocation p_location);
+
+  /// Returns up to p_count - 1 positions, in increasing order and roughly
+  /// evenly spaced, where p_buffer can be split to lex each part separately
+  /// with the same result as lexing it at once. The split points are the
+  /// starts of lines that are not inside a block comment.
+  static std::vector<uint32_t> find_split_points(std::string_view p_buffer, unsigned p_count);
 
   /// Gets the next token from the lexer and stores it in p_token.
   /// If end of file is reached, then p_token is of m_kind P_TOK_EOF
@@ -27,7 +48,7 @@ public:
 
 private:
   void fill_token(PToken& p_token, PTokenKind p_kind);
-  void register_newline();
+  void handle_unknown_character();
 
   void fill_identifier_token(PToken& p_token, bool p_is_raw);
   void fill_integer_literal(PToken& p_token, int p_radix);
@@ -35,9 +56,11 @@ private:
 
 private:
   bool m_keep_comments = false;
+  std::vector<PSourceLocation>* m_deferred_diagnostics = nullptr;
 
   // For re2c:
   const char* m_cursor = nullptr;
+  const char* m_end = nullptr; // the end of the lexed range
   const char* m_marker = nullptr;
   const char* m_marked_cursor = nullptr;
   PSourceLocation m_marked_source_location;
@@ -1,13 +1,15 @@
 /* Generated by re2c */
 #include "lexer.hxx"
 
-#include "utils/diag.hxx"
+#include "utils/char_scan.hxx"
 #include "options.hxx"
 
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 
+#include <hedley.h>
+
 
 
 void
@@ -19,6 +21,12 @@ PLexer::tokenize(PToken& p_token)
         m_marked_cursor = m_cursor;
         m_marked_source_location = m_marked_cursor - source_file->get_buffer_raw();
 
+        // The end of the lexed range (see set_source_range()).
+        if (HEDLEY_UNLIKELY(m_cursor == m_end)) {
+            fill_token(p_token, P_TOK_EOF);
+            break;
+        }
+
 
         
 {
@@ -28,24 +36,24 @@ PLexer::tokenize(PToken& p_token)
     switch (yych) {
         case 0x00: goto yy1;
         case '\t':
+        case '\n':
         case '\v':
         case '\f':
+        case '\r':
         case ' ': goto yy4;
-        case '\n': goto yy7;
-        case '\r': goto yy8;
-        case '!': goto yy9;
-        case '"': goto yy11;
-        case '%': goto yy12;
-        case '&': goto yy14;
-        case '(': goto yy16;
-        case ')': goto yy17;
-        case '*': goto yy18;
-        case '+': goto yy20;
-        case ',': goto yy22;
-        case '-': goto yy23;
-        case '.': goto yy25;
-        case '/': goto yy26;
-        case '0': goto yy28;
+        case '!': goto yy5;
+        case '"': goto yy7;
+        case '%': goto yy8;
+        case '&': goto yy10;
+        case '(': goto yy12;
+        case ')': goto yy13;
+        case '*': goto yy14;
+        case '+': goto yy16;
+        case ',': goto yy18;
+        case '-': goto yy19;
+        case '.': goto yy21;
+        case '/': goto yy22;
+        case '0': goto yy24;
         case '1':
         case '2':
         case '3':
@@ -54,12 +62,12 @@ PLexer::tokenize(PToken& p_token)
         case '6':
         case '7':
         case '8':
-        case '9': goto yy30;
-        case ':': goto yy32;
-        case ';': goto yy33;
-        case '<': goto yy34;
-        case '=': goto yy36;
-        case '>': goto yy38;
+        case '9': goto yy26;
+        case ':': goto yy28;
+        case ';': goto yy29;
+        case '<': goto yy30;
+        case '=': goto yy32;
+        case '>': goto yy34;
         case 'A':
         case 'B':
         case 'C':
@@ -111,14 +119,14 @@ PLexer::tokenize(PToken& p_token)
         case 'w':
         case 'x':
         case 'y':
-        case 'z': goto yy40;
-        case '[': goto yy43;
-        case ']': goto yy44;
-        case '^': goto yy45;
-        case 'r': goto yy47;
-        case '{': goto yy48;
-        case '|': goto yy49;
-        case '}': goto yy51;
+        case 'z': goto yy36;
+        case '[': goto yy39;
+        case ']': goto yy40;
+        case '^': goto yy41;
+        case 'r': goto yy43;
+        case '{': goto yy44;
+        case '|': goto yy45;
+        case '}': goto yy47;
         default: goto yy2;
     }
 yy1:
@@ -133,137 +141,116 @@ yy2:
     ++m_cursor;
 yy3:
     {
-                PDiag* d = diag_at(P_DK_err_unknown_character, m_marked_source_location);
-                diag_add_arg_char(d, m_cursor[-1]);
-                diag_flush(d);
+                handle_unknown_character();
                 continue;
             }
 yy4:
-    yych = *++m_cursor;
-yy5:
-    switch (yych) {
-        case '\t':
-        case '\v':
-        case '\f':
-        case '\r':
-        case ' ': goto yy4;
-        default: goto yy6;
-    }
-yy6:
-    { continue; }
-yy7:
     ++m_cursor;
     {
-                register_newline();
+                m_cursor = p_skip_whitespace(m_cursor, m_end);
                 continue;
             }
-yy8:
-    yych = *++m_cursor;
-    switch (yych) {
-        case '\n': goto yy7;
-        default: goto yy5;
-    }
-yy9:
+yy5:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy52;
-        default: goto yy10;
+        case '=': goto yy48;
+        default: goto yy6;
     }
-yy10:
+yy6:
     { return fill_token(p_token, P_TOK_EXCLAIM); }
-yy11:
+yy7:
     yyaccept = 0;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
         case 0x00:
         case '\n':
         case '\r': goto yy3;
-        default: goto yy54;
+        default: goto yy50;
     }
-yy12:
+yy8:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy58;
-        default: goto yy13;
+        case '=': goto yy54;
+        default: goto yy9;
     }
-yy13:
+yy9:
     { return fill_token(p_token, P_TOK_PERCENT); }
-yy14:
+yy10:
     yych = *++m_cursor;
     switch (yych) {
-        case '&': goto yy59;
-        case '=': goto yy60;
-        default: goto yy15;
+        case '&': goto yy55;
+        case '=': goto yy56;
+        default: goto yy11;
     }
-yy15:
+yy11:
     { return fill_token(p_token, P_TOK_AMP); }
-yy16:
+yy12:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_LPAREN); }
-yy17:
+yy13:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_RPAREN); }
-yy18:
+yy14:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy61;
-        default: goto yy19;
+        case '=': goto yy57;
+        default: goto yy15;
     }
-yy19:
+yy15:
     { return fill_token(p_token, P_TOK_STAR); }
-yy20:
+yy16:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy62;
-        default: goto yy21;
+        case '=': goto yy58;
+        default: goto yy17;
     }
-yy21:
+yy17:
     { return fill_token(p_token, P_TOK_PLUS); }
-yy22:
+yy18:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_COMMA); }
-yy23:
+yy19:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy63;
-        case '>': goto yy64;
-        default: goto yy24;
+        case '=': goto yy59;
+        case '>': goto yy60;
+        default: goto yy20;
     }
-yy24:
+yy20:
     { return fill_token(p_token, P_TOK_MINUS); }
-yy25:
+yy21:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_DOT); }
-yy26:
+yy22:
     yych = *++m_cursor;
     switch (yych) {
-        case '*': goto yy65;
-        case '/': goto yy66;
-        case '=': goto yy68;
-        default: goto yy27;
+        case '*': goto yy61;
+        case '/': goto yy62;
+        case '=': goto yy63;
+        default: goto yy23;
     }
-yy27:
+yy23:
     { return fill_token(p_token, P_TOK_SLASH); }
-yy28:
+yy24:
     yyaccept = 1;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
         case 'B':
-        case 'b': goto yy70;
+        case 'b': goto yy65;
         case 'O':
-        case 'o': goto yy72;
+        case 'o': goto yy67;
         case 'X':
-        case 'x': goto yy73;
-        default: goto yy31;
+        case 'x': goto yy68;
+        default: goto yy27;
     }
-yy29:
+yy25:
     { return fill_integer_literal(p_token, 10); }
-yy30:
+yy26:
     yyaccept = 1;
     yych = *(m_marker = ++m_cursor);
-yy31:
+yy27:
     switch (yych) {
-        case '.': goto yy69;
+        case '.': goto yy64;
         case '0':
         case '1':
         case '2':
@@ -274,49 +261,49 @@ yy31:
         case '7':
         case '8':
         case '9':
-        case '_': goto yy30;
+        case '_': goto yy26;
         case 'E':
-        case 'e': goto yy71;
-        case 'f': goto yy74;
+        case 'e': goto yy66;
+        case 'f': goto yy69;
         case 'i':
-        case 'u': goto yy75;
-        default: goto yy29;
+        case 'u': goto yy70;
+        default: goto yy25;
     }
-yy32:
+yy28:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_COLON); }
-yy33:
+yy29:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_SEMI); }
-yy34:
+yy30:
     yych = *++m_cursor;
     switch (yych) {
-        case '<': goto yy76;
-        case '=': goto yy78;
-        default: goto yy35;
+        case '<': goto yy71;
+        case '=': goto yy73;
+        default: goto yy31;
     }
-yy35:
+yy31:
     { return fill_token(p_token, P_TOK_LESS); }
-yy36:
+yy32:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy79;
-        default: goto yy37;
+        case '=': goto yy74;
+        default: goto yy33;
     }
-yy37:
+yy33:
     { return fill_token(p_token, P_TOK_EQUAL); }
-yy38:
+yy34:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy80;
-        case '>': goto yy81;
-        default: goto yy39;
+        case '=': goto yy75;
+        case '>': goto yy76;
+        default: goto yy35;
     }
-yy39:
+yy35:
     { return fill_token(p_token, P_TOK_GREATER); }
-yy40:
+yy36:
     yych = *++m_cursor;
-yy41:
+yy37:
     switch (yych) {
         case '0':
         case '1':
@@ -380,76 +367,76 @@ yy41:
         case 'w':
         case 'x':
         case 'y':
-        case 'z': goto yy40;
-        default: goto yy42;
+        case 'z': goto yy36;
+        default: goto yy38;
     }
-yy42:
+yy38:
     { return fill_identifier_token(p_token, false); }
-yy43:
+yy39:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_LSQUARE); }
-yy44:
+yy40:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_RSQUARE); }
-yy45:
+yy41:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy83;
-        default: goto yy46;
+        case '=': goto yy78;
+        default: goto yy42;
     }
-yy46:
+yy42:
     { return fill_token(p_token, P_TOK_CARET); }
-yy47:
+yy43:
     yyaccept = 2;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
-        case '#': goto yy84;
-        default: goto yy41;
+        case '#': goto yy79;
+        default: goto yy37;
     }
-yy48:
+yy44:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_LBRACE); }
-yy49:
+yy45:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy85;
-        case '|': goto yy86;
-        default: goto yy50;
+        case '=': goto yy80;
+        case '|': goto yy81;
+        default: goto yy46;
     }
-yy50:
+yy46:
     { return fill_token(p_token, P_TOK_PIPE); }
-yy51:
+yy47:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_RBRACE); }
-yy52:
+yy48:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_EXCLAIM_EQUAL); }
-yy53:
+yy49:
     yych = *++m_cursor;
-yy54:
+yy50:
     switch (yych) {
         case 0x00:
         case '\n':
-        case '\r': goto yy55;
-        case '"': goto yy56;
-        case '\\': goto yy57;
-        default: goto yy53;
+        case '\r': goto yy51;
+        case '"': goto yy52;
+        case '\\': goto yy53;
+        default: goto yy49;
     }
-yy55:
+yy51:
     m_cursor = m_marker;
     switch (yyaccept) {
         case 0: goto yy3;
-        case 1: goto yy29;
-        case 2: goto yy42;
-        case 3: goto yy90;
-        case 4: goto yy92;
-        case 5: goto yy97;
-        default: goto yy99;
+        case 1: goto yy25;
+        case 2: goto yy38;
+        case 3: goto yy85;
+        case 4: goto yy87;
+        case 5: goto yy92;
+        default: goto yy94;
     }
-yy56:
+yy52:
     ++m_cursor;
     { return fill_string_literal(p_token); }
-yy57:
+yy53:
     yych = *++m_cursor;
     switch (yych) {
         case '"':
@@ -458,45 +445,39 @@ yy57:
         case '\\':
         case 'n':
         case 'r':
-        case 't': goto yy53;
-        case 'u': goto yy87;
-        case 'x': goto yy88;
-        default: goto yy55;
+        case 't': goto yy49;
+        case 'u': goto yy82;
+        case 'x': goto yy83;
+        default: goto yy51;
     }
-yy58:
+yy54:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_PERCENT_EQUAL); }
-yy59:
+yy55:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_AMP_AMP); }
-yy60:
+yy56:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_AMP_EQUAL); }
-yy61:
+yy57:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_STAR_EQUAL); }
-yy62:
+yy58:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_PLUS_EQUAL); }
-yy63:
+yy59:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_MINUS_EQUAL); }
-yy64:
+yy60:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_ARROW); }
-yy65:
+yy61:
     ++m_cursor;
     { goto block_comment; }
-yy66:
-    yych = *++m_cursor;
-    switch (yych) {
-        case 0x00:
-        case '\n':
-        case '\r': goto yy67;
-        default: goto yy66;
-    }
-yy67:
+yy62:
+    ++m_cursor;
     {
+                m_cursor = p_find_line_end(m_cursor, m_end);
                 if (!m_keep_comments)
                     continue;
 
@@ -505,10 +486,10 @@ yy67:
                 p_token.data.literal.end = m_cursor;
                 break;
             }
-yy68:
+yy63:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_SLASH_EQUAL); }
-yy69:
+yy64:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -520,25 +501,25 @@ yy69:
         case '6':
         case '7':
         case '8':
-        case '9': goto yy89;
-        default: goto yy55;
+        case '9': goto yy84;
+        default: goto yy51;
     }
-yy70:
+yy65:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
-        case '1': goto yy91;
-        case '_': goto yy70;
-        default: goto yy55;
+        case '1': goto yy86;
+        case '_': goto yy65;
+        default: goto yy51;
     }
-yy71:
+yy66:
     yych = *++m_cursor;
     switch (yych) {
         case '+':
-        case '-': goto yy93;
-        default: goto yy94;
+        case '-': goto yy88;
+        default: goto yy89;
     }
-yy72:
+yy67:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -548,11 +529,11 @@ yy72:
         case '4':
         case '5':
         case '6':
-        case '7': goto yy96;
-        case '_': goto yy72;
-        default: goto yy55;
+        case '7': goto yy91;
+        case '_': goto yy67;
+        default: goto yy51;
     }
-yy73:
+yy68:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -576,55 +557,55 @@ yy73:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy98;
-        case '_': goto yy73;
-        default: goto yy55;
+        case 'f': goto yy93;
+        case '_': goto yy68;
+        default: goto yy51;
     }
-yy74:
+yy69:
     yych = *++m_cursor;
     switch (yych) {
-        case '3': goto yy100;
-        case '6': goto yy101;
-        default: goto yy55;
+        case '3': goto yy95;
+        case '6': goto yy96;
+        default: goto yy51;
     }
-yy75:
+yy70:
     yych = *++m_cursor;
     switch (yych) {
-        case '1': goto yy102;
-        case '3': goto yy103;
-        case '6': goto yy104;
-        case '8': goto yy105;
-        default: goto yy55;
+        case '1': goto yy97;
+        case '3': goto yy98;
+        case '6': goto yy99;
+        case '8': goto yy100;
+        default: goto yy51;
     }
-yy76:
+yy71:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy106;
-        default: goto yy77;
+        case '=': goto yy101;
+        default: goto yy72;
     }
-yy77:
+yy72:
     { return fill_token(p_token, P_TOK_LESS_LESS); }
-yy78:
+yy73:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_LESS_EQUAL); }
-yy79:
+yy74:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_EQUAL_EQUAL); }
-yy80:
+yy75:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_GREATER_EQUAL); }
-yy81:
+yy76:
     yych = *++m_cursor;
     switch (yych) {
-        case '=': goto yy107;
-        default: goto yy82;
+        case '=': goto yy102;
+        default: goto yy77;
     }
-yy82:
+yy77:
     { return fill_token(p_token, P_TOK_GREATER_GREATER); }
-yy83:
+yy78:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_CARET_EQUAL); }
-yy84:
+yy79:
     yych = *++m_cursor;
     switch (yych) {
         case 'A':
@@ -679,22 +660,22 @@ yy84:
         case 'w':
         case 'x':
         case 'y':
-        case 'z': goto yy108;
-        default: goto yy55;
+        case 'z': goto yy103;
+        default: goto yy51;
     }
-yy85:
+yy80:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_PIPE_EQUAL); }
-yy86:
+yy81:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_PIPE_PIPE); }
-yy87:
+yy82:
     yych = *++m_cursor;
     switch (yych) {
-        case '{': goto yy110;
-        default: goto yy55;
+        case '{': goto yy105;
+        default: goto yy51;
     }
-yy88:
+yy83:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -704,10 +685,10 @@ yy88:
         case '4':
         case '5':
         case '6':
-        case '7': goto yy111;
-        default: goto yy55;
+        case '7': goto yy106;
+        default: goto yy51;
     }
-yy89:
+yy84:
     yyaccept = 3;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
@@ -721,13 +702,13 @@ yy89:
         case '7':
         case '8':
         case '9':
-        case '_': goto yy89;
+        case '_': goto yy84;
         case 'E':
-        case 'e': goto yy71;
-        case 'f': goto yy74;
-        default: goto yy90;
+        case 'e': goto yy66;
+        case 'f': goto yy69;
+        default: goto yy85;
     }
-yy90:
+yy85:
     {
                 FILL_TOKEN(P_TOK_FLOAT_LITERAL);
                 p_token.data.literal.begin = m_marked_cursor;
@@ -749,22 +730,22 @@ yy90:
 
                 break;
             }
-yy91:
+yy86:
     yyaccept = 4;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
         case '0':
         case '1':
-        case '_': goto yy91;
+        case '_': goto yy86;
         case 'i':
-        case 'u': goto yy112;
-        default: goto yy92;
+        case 'u': goto yy107;
+        default: goto yy87;
     }
-yy92:
+yy87:
     { return fill_integer_literal(p_token, 2); }
-yy93:
+yy88:
     yych = *++m_cursor;
-yy94:
+yy89:
     switch (yych) {
         case '0':
         case '1':
@@ -775,11 +756,11 @@ yy94:
         case '6':
         case '7':
         case '8':
-        case '9': goto yy95;
-        case '_': goto yy93;
-        default: goto yy55;
+        case '9': goto yy90;
+        case '_': goto yy88;
+        default: goto yy51;
     }
-yy95:
+yy90:
     yyaccept = 3;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
@@ -793,11 +774,11 @@ yy95:
         case '7':
         case '8':
         case '9':
-        case '_': goto yy95;
-        case 'f': goto yy74;
-        default: goto yy90;
+        case '_': goto yy90;
+        case 'f': goto yy69;
+        default: goto yy85;
     }
-yy96:
+yy91:
     yyaccept = 5;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
@@ -809,14 +790,14 @@ yy96:
         case '5':
         case '6':
         case '7':
-        case '_': goto yy96;
+        case '_': goto yy91;
         case 'i':
-        case 'u': goto yy113;
-        default: goto yy97;
+        case 'u': goto yy108;
+        default: goto yy92;
     }
-yy97:
+yy92:
     { return fill_integer_literal(p_token, 8); }
-yy98:
+yy93:
     yyaccept = 6;
     yych = *(m_marker = ++m_cursor);
     switch (yych) {
@@ -842,53 +823,53 @@ yy98:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy98;
+        case 'f': goto yy93;
         case 'i':
-        case 'u': goto yy114;
-        default: goto yy99;
+        case 'u': goto yy109;
+        default: goto yy94;
     }
-yy99:
+yy94:
     { return fill_integer_literal(p_token, 16); }
-yy100:
+yy95:
     yych = *++m_cursor;
     switch (yych) {
-        case '2': goto yy115;
-        default: goto yy55;
+        case '2': goto yy110;
+        default: goto yy51;
     }
-yy101:
+yy96:
     yych = *++m_cursor;
     switch (yych) {
-        case '4': goto yy115;
-        default: goto yy55;
+        case '4': goto yy110;
+        default: goto yy51;
     }
-yy102:
+yy97:
     yych = *++m_cursor;
     switch (yych) {
-        case '6': goto yy105;
-        default: goto yy55;
+        case '6': goto yy100;
+        default: goto yy51;
     }
-yy103:
+yy98:
     yych = *++m_cursor;
     switch (yych) {
-        case '2': goto yy105;
-        default: goto yy55;
+        case '2': goto yy100;
+        default: goto yy51;
     }
-yy104:
+yy99:
     yych = *++m_cursor;
     switch (yych) {
-        case '4': goto yy105;
-        default: goto yy55;
+        case '4': goto yy100;
+        default: goto yy51;
     }
-yy105:
+yy100:
     ++m_cursor;
-    goto yy29;
-yy106:
+    goto yy25;
+yy101:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_LESS_LESS_EQUAL); }
-yy107:
+yy102:
     ++m_cursor;
     { return fill_token(p_token, P_TOK_GREATER_GREATER_EQUAL); }
-yy108:
+yy103:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -953,12 +934,12 @@ yy108:
         case 'w':
         case 'x':
         case 'y':
-        case 'z': goto yy108;
-        default: goto yy109;
+        case 'z': goto yy103;
+        default: goto yy104;
     }
-yy109:
+yy104:
     { return fill_identifier_token(p_token, true); }
-yy110:
+yy105:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -982,10 +963,10 @@ yy110:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy116;
-        default: goto yy55;
+        case 'f': goto yy111;
+        default: goto yy51;
     }
-yy111:
+yy106:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -1009,40 +990,40 @@ yy111:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy53;
-        default: goto yy55;
+        case 'f': goto yy49;
+        default: goto yy51;
     }
-yy112:
+yy107:
     yych = *++m_cursor;
     switch (yych) {
-        case '1': goto yy117;
-        case '3': goto yy118;
-        case '6': goto yy119;
-        case '8': goto yy120;
-        default: goto yy55;
+        case '1': goto yy112;
+        case '3': goto yy113;
+        case '6': goto yy114;
+        case '8': goto yy115;
+        default: goto yy51;
     }
-yy113:
+yy108:
     yych = *++m_cursor;
     switch (yych) {
-        case '1': goto yy121;
-        case '3': goto yy122;
-        case '6': goto yy123;
-        case '8': goto yy124;
-        default: goto yy55;
+        case '1': goto yy116;
+        case '3': goto yy117;
+        case '6': goto yy118;
+        case '8': goto yy119;
+        default: goto yy51;
     }
-yy114:
+yy109:
     yych = *++m_cursor;
     switch (yych) {
-        case '1': goto yy125;
-        case '3': goto yy126;
-        case '6': goto yy127;
-        case '8': goto yy128;
-        default: goto yy55;
+        case '1': goto yy120;
+        case '3': goto yy121;
+        case '6': goto yy122;
+        case '8': goto yy123;
+        default: goto yy51;
     }
-yy115:
+yy110:
     ++m_cursor;
-    goto yy90;
-yy116:
+    goto yy85;
+yy111:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -1066,75 +1047,75 @@ yy116:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy129;
-        case '_': goto yy116;
-        case '}': goto yy53;
-        default: goto yy55;
+        case 'f': goto yy124;
+        case '_': goto yy111;
+        case '}': goto yy49;
+        default: goto yy51;
     }
-yy117:
+yy112:
     yych = *++m_cursor;
     switch (yych) {
-        case '6': goto yy120;
-        default: goto yy55;
+        case '6': goto yy115;
+        default: goto yy51;
     }
-yy118:
+yy113:
     yych = *++m_cursor;
     switch (yych) {
-        case '2': goto yy120;
-        default: goto yy55;
+        case '2': goto yy115;
+        default: goto yy51;
     }
-yy119:
+yy114:
     yych = *++m_cursor;
     switch (yych) {
-        case '4': goto yy120;
-        default: goto yy55;
+        case '4': goto yy115;
+        default: goto yy51;
     }
-yy120:
+yy115:
     ++m_cursor;
-    goto yy92;
-yy121:
+    goto yy87;
+yy116:
     yych = *++m_cursor;
     switch (yych) {
-        case '6': goto yy124;
-        default: goto yy55;
+        case '6': goto yy119;
+        default: goto yy51;
     }
-yy122:
+yy117:
     yych = *++m_cursor;
     switch (yych) {
-        case '2': goto yy124;
-        default: goto yy55;
+        case '2': goto yy119;
+        default: goto yy51;
     }
-yy123:
+yy118:
     yych = *++m_cursor;
     switch (yych) {
-        case '4': goto yy124;
-        default: goto yy55;
+        case '4': goto yy119;
+        default: goto yy51;
     }
-yy124:
+yy119:
     ++m_cursor;
-    goto yy97;
-yy125:
+    goto yy92;
+yy120:
     yych = *++m_cursor;
     switch (yych) {
-        case '6': goto yy128;
-        default: goto yy55;
+        case '6': goto yy123;
+        default: goto yy51;
     }
-yy126:
+yy121:
     yych = *++m_cursor;
     switch (yych) {
-        case '2': goto yy128;
-        default: goto yy55;
+        case '2': goto yy123;
+        default: goto yy51;
     }
-yy127:
+yy122:
     yych = *++m_cursor;
     switch (yych) {
-        case '4': goto yy128;
-        default: goto yy55;
+        case '4': goto yy123;
+        default: goto yy51;
     }
-yy128:
+yy123:
     ++m_cursor;
-    goto yy99;
-yy129:
+    goto yy94;
+yy124:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -1158,12 +1139,12 @@ yy129:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy130;
-        case '_': goto yy129;
-        case '}': goto yy53;
-        default: goto yy55;
+        case 'f': goto yy125;
+        case '_': goto yy124;
+        case '}': goto yy49;
+        default: goto yy51;
     }
-yy130:
+yy125:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -1187,12 +1168,12 @@ yy130:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy131;
-        case '_': goto yy130;
-        case '}': goto yy53;
-        default: goto yy55;
+        case 'f': goto yy126;
+        case '_': goto yy125;
+        case '}': goto yy49;
+        default: goto yy51;
     }
-yy131:
+yy126:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -1216,12 +1197,12 @@ yy131:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy132;
-        case '_': goto yy131;
-        case '}': goto yy53;
-        default: goto yy55;
+        case 'f': goto yy127;
+        case '_': goto yy126;
+        case '}': goto yy49;
+        default: goto yy51;
     }
-yy132:
+yy127:
     yych = *++m_cursor;
     switch (yych) {
         case '0':
@@ -1245,17 +1226,17 @@ yy132:
         case 'c':
         case 'd':
         case 'e':
-        case 'f': goto yy133;
-        case '_': goto yy132;
-        case '}': goto yy53;
-        default: goto yy55;
+        case 'f': goto yy128;
+        case '_': goto yy127;
+        case '}': goto yy49;
+        default: goto yy51;
     }
-yy133:
+yy128:
     yych = *++m_cursor;
     switch (yych) {
-        case '_': goto yy133;
-        case '}': goto yy53;
-        default: goto yy55;
+        case '_': goto yy128;
+        case '}': goto yy49;
+        default: goto yy51;
     }
 }
 
@@ -1266,13 +1247,11 @@ yy133:
     char yych;
     yych = *m_cursor;
     switch (yych) {
-        case 0x00: goto yy135;
-        case '\n': goto yy138;
-        case '\r': goto yy139;
-        case '*': goto yy140;
-        default: goto yy136;
+        case 0x00: goto yy130;
+        case '*': goto yy133;
+        default: goto yy131;
     }
-yy135:
+yy130:
     ++m_cursor;
     {
                 // Unterminated block comment
@@ -1280,31 +1259,19 @@ yy135:
                 m_cursor--;
                 break;
             }
-yy136:
-    ++m_cursor;
-yy137:
-    {
-                goto block_comment;
-            }
-yy138:
+yy131:
     ++m_cursor;
+yy132:
     {
-                register_newline();
                 goto block_comment;
             }
-yy139:
-    yych = *++m_cursor;
-    switch (yych) {
-        case '\n': goto yy138;
-        default: goto yy137;
-    }
-yy140:
+yy133:
     yych = *++m_cursor;
     switch (yych) {
-        case '/': goto yy141;
-        default: goto yy137;
+        case '/': goto yy134;
+        default: goto yy132;
     }
-yy141:
+yy134:
     ++m_cursor;
     {
                 if (!m_keep_comments)
@@ -11,7 +11,6 @@ protected:
 
   void SetUp() override
   {
-    identifier_table.register_keywords();
     lexer.identifier_table = &identifier_table;
   }
 
@@ -52,17 +51,20 @@ protected:
                          uint32_t p_end_line,
                          uint32_t p_end_col,
                          int p_radix,
-                         PIntLiteralSuffix p_suffix)
+                         PIntLiteralSuffix p_suffix,
+                         uint64_t p_value)
   {
     PToken token = check_token(P_TOK_INT_LITERAL, p_begin_line, p_begin_col, p_end_line, p_end_col);
     EXPECT_EQ(token.data.literal.int_radix, p_radix);
     EXPECT_EQ(token.data.literal.suffix_kind, p_suffix);
+    EXPECT_FALSE(token.data.literal.int_overflow);
+    EXPECT_EQ(token.data.literal.int_value, p_value);
   }
 };
 
 TEST_F(lexer_test, ident_and_keywords)
 {
-  set_input("foo r#foo i32 r#i32");
+  set_input("foo r#foo i32 r#i32 i320 fns");
 
   PToken foo = check_token(P_TOK_IDENTIFIER, 1, 1, 1, 4);
   EXPECT_EQ(foo.data.identifier->get_spelling(), "foo");
@@ -70,13 +72,18 @@ TEST_F(lexer_test, ident_and_keywords)
   PToken raw_foo = check_token(P_TOK_IDENTIFIER, 1, 5, 1, 10);
   EXPECT_EQ(raw_foo.data.identifier->get_spelling(), "foo");
 
-  PToken i32 = check_token(P_TOK_KEY_i32, 1, 11, 1, 14);
-  EXPECT_EQ(i32.data.identifier->get_spelling(), "i32");
+  check_token(P_TOK_KEY_i32, 1, 11, 1, 14);
 
   PToken raw_i32 = check_token(P_TOK_IDENTIFIER, 1, 15, 1, 20);
   EXPECT_EQ(raw_i32.data.identifier->get_spelling(), "i32");
 
-  check_token(P_TOK_EOF, 1, 20, 1, 20);
+  // Identifiers that only start like a keyword.
+  PToken i320 = check_token(P_TOK_IDENTIFIER, 1, 21, 1, 25);
+  EXPECT_EQ(i320.data.identifier->get_spelling(), "i320");
+  PToken fns = check_token(P_TOK_IDENTIFIER, 1, 26, 1, 29);
+  EXPECT_EQ(fns.data.identifier->get_spelling(), "fns");
+
+  check_token(P_TOK_EOF, 1, 29, 1, 29);
 }
 
 TEST_F(lexer_test, comments)
@@ -116,28 +123,33 @@ TEST_F(lexer_test, integer_literals)
 {
   // Decimal integer literal
   set_input("0 10i32 5_2_8_ 5___5u64 8___i8");
-  check_int_literal(1, 1, 1, 2, 10, P_ILS_NO_SUFFIX);
-  check_int_literal(1, 3, 1, 8, 10, P_ILS_I32);
-  check_int_literal(1, 9, 1, 15, 10, P_ILS_NO_SUFFIX);
-  check_int_literal(1, 16, 1, 24, 10, P_ILS_U64);
-  check_int_literal(1, 25, 1, 31, 10, P_ILS_I8);
+  check_int_literal(1, 1, 1, 2, 10, P_ILS_NO_SUFFIX, 0);
+  check_int_literal(1, 3, 1, 8, 10, P_ILS_I32, 10);
+  check_int_literal(1, 9, 1, 15, 10, P_ILS_NO_SUFFIX, 528);
+  check_int_literal(1, 16, 1, 24, 10, P_ILS_U64, 55);
+  check_int_literal(1, 25, 1, 31, 10, P_ILS_I8, 8);
   check_token(P_TOK_EOF, 1, 31, 1, 31);
 
   // Binary integer literal
   set_input("0b0 0B1i32 0b1_10_1__u8 0B__1_1___");
-  check_int_literal(1, 1, 1, 4, 2, P_ILS_NO_SUFFIX);
-  check_int_literal(1, 5, 1, 11, 2, P_ILS_I32);
-  check_int_literal(1, 12, 1, 24, 2, P_ILS_U8);
-  check_int_literal(1, 25, 1, 35, 2, P_ILS_NO_SUFFIX);
+  check_int_literal(1, 1, 1, 4, 2, P_ILS_NO_SUFFIX, 0);
+  check_int_literal(1, 5, 1, 11, 2, P_ILS_I32, 1);
+  check_int_literal(1, 12, 1, 24, 2, P_ILS_U8, 13);
+  check_int_literal(1, 25, 1, 35, 2, P_ILS_NO_SUFFIX, 3);
   check_token(P_TOK_EOF, 1, 35, 1, 35);
 
   // Hexadecimal integer literal
   set_input("0x15 0Xfai64 0x_7__ 0x5_f5_u16");
-  check_int_literal(1, 1, 1, 5, 16, P_ILS_NO_SUFFIX);
-  check_int_literal(1, 6, 1, 13, 16, P_ILS_I64);
-  check_int_literal(1, 14, 1, 20, 16, P_ILS_NO_SUFFIX);
-  check_int_literal(1, 21, 1, 31, 16, P_ILS_U16);
+  check_int_literal(1, 1, 1, 5, 16, P_ILS_NO_SUFFIX, 0x15);
+  check_int_literal(1, 6, 1, 13, 16, P_ILS_I64, 0xfa);
+  check_int_literal(1, 14, 1, 20, 16, P_ILS_NO_SUFFIX, 0x7);
+  check_int_literal(1, 21, 1, 31, 16, P_ILS_U16, 0x5f5);
   check_token(P_TOK_EOF, 1, 31, 1, 31);
+
+  // Too large integer literal
+  set_input("18446744073709551616");
+  PToken token = check_token(P_TOK_INT_LITERAL, 1, 1, 1, 21);
+  EXPECT_TRUE(token.data.literal.int_overflow);
 }
 
 TEST_F(lexer_test, string_literals)
@@ -176,3 +188,33 @@ TEST_F(lexer_test, operators)
   pos += 3;
   check_token(P_TOK_GREATER_GREATER_EQUAL, 1, pos, 1, pos + 3);
 }
+
+TEST_F(lexer_test, source_range)
+{
+  set_input("foo bar\nbaz");
+  lexer.set_source_range(4, 8);
+  check_token(P_TOK_IDENTIFIER, 1, 5, 1, 8);
+  check_token(P_TOK_EOF, 2, 1, 2, 1);
+}
+
+TEST(lexer_split_points, skip_comments_and_strings)
+{
+  using namespace std::string_view_literals;
+
+  // Each line is a candidate, the split points are the first ones after each
+  // 1/4 of the buffer.
+  EXPECT_EQ(PLexer::find_split_points("a\nb\nc\nd\ne\nf\ng\nh\n", 4), (std::vector<uint32_t>{ 6, 10, 14 }));
+  EXPECT_TRUE(PLexer::find_split_points("a\nb\nc\nd\n", 1).empty());
+
+  // Not inside block comments.
+  EXPECT_EQ(PLexer::find_split_points("/*\n\n\n*/\n\n", 2), (std::vector<uint32_t>{ 8 }));
+  EXPECT_TRUE(PLexer::find_split_points("/*\n\n\n\n\n\n", 2).empty());
+  // Block comments starts are ignored in line comments and string literals.
+  EXPECT_EQ(PLexer::find_split_points("// /*\n\n\n\n\n\n", 2), (std::vector<uint32_t>{ 6 }));
+  EXPECT_EQ(PLexer::find_split_points("\"/*\\\"\"\n\n\n\n\n\n", 2), (std::vector<uint32_t>{ 7 }));
+  // But not after an invalid string literal (the quote is an unknown
+  // character).
+  EXPECT_TRUE(PLexer::find_split_points("\"\\q/*\"\n\n\n\n\n\n", 2).empty());
+  // The lexing ends at a NUL character.
+  EXPECT_TRUE(PLexer::find_split_points("a\0\n\n\n\n\n\n"sv, 2).empty());
+}
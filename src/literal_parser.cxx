@@ -1,10 +1,15 @@
 #include "literal_parser.hxx"
 
+#include "utils/char_scan.hxx"
+
+#include <bit>
 #include <cassert>
-#include <cerrno>
+#include <cfloat>
 #include <climits>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 
 /// Do `*p_acc += p_value` checking for overflow. Returns true in case of
 /// overflow, otherwise false is returned.
@@ -69,23 +74,120 @@ to_digit(char p_ch, int p_radix)
   }
 }
 
+// The functions below convert 8 digits at a time, loaded as a single
+// little-endian 64-bit word (SWAR: SIMD within a register). Digit
+// separators are rare, so a word containing one is simply converted by the
+// scalar loop of parse_int_literal_helper().
+
+/// Byte-wise constant: p_byte repeated in the 8 bytes of a word.
+static constexpr uint64_t
+repeat_byte(uint8_t p_byte)
+{
+  return 0x0101010101010101ull * p_byte;
+}
+
+/// Returns true if the 8 bytes of p_word are decimal digits.
+static inline bool
+is_eight_dec_digits(uint64_t p_word)
+{
+  // A byte is a digit if its high nibble is 3 before and after adding 6.
+  return ((p_word & repeat_byte(0xF0)) | (((p_word + repeat_byte(0x06)) & repeat_byte(0xF0)) >> 4)) ==
+         repeat_byte(0x33);
+}
+
+/// Returns the value of the 8 decimal digits of p_word (the first one being
+/// the most significant).
+static inline uint32_t
+parse_eight_dec_digits(uint64_t p_word)
+{
+  p_word -= repeat_byte('0');
+  p_word = (p_word * 10) + (p_word >> 8); // pairs of digits
+  p_word = (((p_word & 0x000000FF000000FF) * (100 + (1000000ull << 32))) +
+            (((p_word >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32)))) >>
+           32;
+  return static_cast<uint32_t>(p_word);
+}
+
+/// Returns the high bit of each byte of p_word set if that byte is strictly
+/// between p_low and p_high, for bytes less than 0x80.
+static constexpr uint64_t
+bytes_between(uint64_t p_word, uint8_t p_low, uint8_t p_high)
+{
+  const uint64_t low_bits = p_word & repeat_byte(0x7F);
+  return (repeat_byte(127 + p_high) - low_bits) & ~p_word & (low_bits + repeat_byte(127 - p_low)) &
+         repeat_byte(0x80);
+}
+
+/// Returns true if the 8 bytes of p_word are hexadecimal digits.
+static inline bool
+is_eight_hex_digits(uint64_t p_word)
+{
+  const uint64_t lower = p_word | repeat_byte(0x20); // does not change digits
+  return (bytes_between(lower, '0' - 1, '9' + 1) | bytes_between(lower, 'a' - 1, 'f' + 1)) == repeat_byte(0x80);
+}
+
+/// Returns the value of the 8 hexadecimal digits of p_word (the first one
+/// being the most significant).
+static inline uint32_t
+parse_eight_hex_digits(uint64_t p_word)
+{
+  // Letters have the bit 6 set, and their low nibble is their value minus 9.
+  uint64_t nibbles = (p_word & repeat_byte(0x0F)) + ((p_word >> 6) & repeat_byte(0x01)) * 9;
+  nibbles = ((nibbles << 4) | (nibbles >> 8)) & 0x00FF00FF00FF00FF;  // bytes
+  nibbles = ((nibbles << 8) | (nibbles >> 16)) & 0x0000FFFF0000FFFF; // 16-bit halves
+  return static_cast<uint32_t>((nibbles << 16) | (nibbles >> 32));
+}
+
+/// Converts the 8 digits starting at p_begin if they are all valid digits
+/// in p_radix (10 or 16). Returns true and accumulates them into p_value
+/// (setting p_overflow on overflow) on success.
+static inline bool
+parse_eight_digits(const char* p_begin, int p_radix, uintmax_t& p_value, bool& p_overflow)
+{
+  if constexpr (std::endian::native != std::endian::little) {
+    return false;
+  } else {
+    uint64_t word;
+    memcpy(&word, p_begin, sizeof(word));
+
+    if (p_radix == 10) {
+      if (!is_eight_dec_digits(word))
+        return false;
+      p_overflow |= safe_mul(p_value, 100000000);
+      p_overflow |= safe_add(p_value, parse_eight_dec_digits(word));
+    } else {
+      assert(p_radix == 16);
+      if (!is_eight_hex_digits(word))
+        return false;
+      p_overflow |= safe_mul(p_value, 1ull << 32);
+      p_overflow |= safe_add(p_value, parse_eight_hex_digits(word));
+    }
+
+    return true;
+  }
+}
+
 static inline bool
 parse_int_literal_helper(const char* p_begin, const char* p_end, uintmax_t& p_value, int p_radix)
 {
   bool overflow = false;
-  uintmax_t digit;
 
   p_value = 0;
-  while (*p_begin != *p_end) {
-    char ch = *p_begin++;
-    if (ch == '_') { // digit separator
+  while (p_begin != p_end) {
+    if ((p_radix == 10 || p_radix == 16) && p_end - p_begin >= 8 &&
+        parse_eight_digits(p_begin, p_radix, p_value, overflow)) {
+      p_begin += 8;
       continue;
-    } else if ((digit = to_digit(ch, p_radix)) >= 0) {
-      overflow |= safe_mul(p_value, p_radix);
-      overflow |= safe_add(p_value, digit);
-    } else {
-      assert(0 && "invalid character in integer literal");
     }
+
+    char ch = *p_begin++;
+    if (ch == '_') // digit separator
+      continue;
+
+    const int digit = to_digit(ch, p_radix);
+    assert(digit >= 0 && "invalid character in integer literal");
+    overflow |= safe_mul(p_value, p_radix);
+    overflow |= safe_add(p_value, digit);
   }
 
   return overflow;
@@ -150,35 +252,333 @@ parse_int_literal_token(const char* p_begin, const char* p_end, int p_radix, uin
   }
 }
 
-bool
-parse_float_literal_token(const char* p_begin, const char* p_end, double& p_value)
+// Float literals are converted with the Eisel-Lemire algorithm (as in the
+// fast_float library): the decimal significand (up to 19 digits) is
+// multiplied by a 128-bit approximation of the power of ten, which is almost
+// always enough to know the correctly rounded result. When the literal has
+// more significant digits, or the result is too close to a halfway point to
+// decide, strtod() is used instead.
+
+/// Properties of a binary floating-point format.
+template<class T>
+struct PBinaryFormat;
+
+template<>
+struct PBinaryFormat<double>
 {
-  assert(p_begin != nullptr && p_begin != p_end);
+  using PBits = uint64_t;
+  static constexpr int MANTISSA_BITS = 52; // without the implicit bit
+  static constexpr int MINIMUM_EXPONENT = -1023;
+  static constexpr int INFINITE_POWER = 0x7FF;
+  // Outside of this range, the value is always zero or infinite.
+  static constexpr int SMALLEST_POWER_OF_TEN = -342;
+  static constexpr int LARGEST_POWER_OF_TEN = 308;
+  // The range of powers of ten for which a decimal can fall exactly halfway
+  // between two floats.
+  static constexpr int MIN_EXPONENT_ROUND_TO_EVEN = -4;
+  static constexpr int MAX_EXPONENT_ROUND_TO_EVEN = 23;
+  // Clinger's fast path: when both the significand and the power of ten are
+  // exactly representable, a single multiplication or division is correctly
+  // rounded.
+  static constexpr int MAX_EXACT_POWER_OF_TEN = 22;
+  static constexpr uint64_t MAX_EXACT_SIGNIFICAND = uint64_t(1) << 53;
+
+  static double parse_slow(const char* p_buffer) { return strtod(p_buffer, nullptr); }
+};
+
+template<>
+struct PBinaryFormat<float>
+{
+  using PBits = uint32_t;
+  static constexpr int MANTISSA_BITS = 23;
+  static constexpr int MINIMUM_EXPONENT = -127;
+  static constexpr int INFINITE_POWER = 0xFF;
+  static constexpr int SMALLEST_POWER_OF_TEN = -64;
+  static constexpr int LARGEST_POWER_OF_TEN = 38;
+  static constexpr int MIN_EXPONENT_ROUND_TO_EVEN = -17;
+  static constexpr int MAX_EXPONENT_ROUND_TO_EVEN = 10;
+  static constexpr int MAX_EXACT_POWER_OF_TEN = 10;
+  static constexpr uint64_t MAX_EXACT_SIGNIFICAND = uint64_t(1) << 24;
+
+  static float parse_slow(const char* p_buffer) { return strtof(p_buffer, nullptr); }
+};
+
+/// The decimal value of a float literal: significand * 10^exponent.
+struct PDecimal
+{
+  uint64_t significand = 0;
+  int64_t exponent = 0;
+  // True if some non-zero digits did not fit in significand, the value is
+  // then in (significand * 10^exponent, (significand + 1) * 10^exponent).
+  bool truncated = false;
+};
+
+/// Reads the digits of a float literal, skipping digit separators.
+static PDecimal
+parse_decimal(const char* p_begin, const char* p_end)
+{
+  // The count of decimal digits that always fit in 64 bits.
+  constexpr int MAX_DIGITS = 19;
 
-  const size_t buffer_size = sizeof(char) * (p_end - p_begin + 1 /* NUL-terminated */);
-  char* buffer = static_cast<char*>(malloc(buffer_size));
-  assert(buffer != nullptr);
+  PDecimal decimal;
+  int digit_count = 0; // significant digits stored in significand
+  const char* it = p_begin;
 
-  char* it = buffer;
-  while (p_begin != p_end) {
-    if (*p_begin == '_') {
-      // digit separator
-      ++p_begin;
+  // Integer part.
+  for (; it != p_end && *it != '.' && (*it | 0x20) != 'e'; ++it) {
+    if (*it == '_')
       continue;
+
+    const int digit = *it - '0';
+    if (digit_count < MAX_DIGITS) {
+      decimal.significand = decimal.significand * 10 + digit;
+      digit_count += (decimal.significand != 0); // leading zeros are not significant
+    } else {
+      ++decimal.exponent;
+      decimal.truncated |= (digit != 0);
+    }
+  }
+
+  // Fractional part.
+  if (it != p_end && *it == '.') {
+    for (++it; it != p_end && (*it | 0x20) != 'e'; ++it) {
+      if (*it == '_')
+        continue;
+
+      const int digit = *it - '0';
+      if (digit_count < MAX_DIGITS) {
+        decimal.significand = decimal.significand * 10 + digit;
+        digit_count += (decimal.significand != 0);
+        --decimal.exponent;
+      } else {
+        decimal.truncated |= (digit != 0);
+      }
+    }
+  }
+
+  // Exponent.
+  if (it != p_end) {
+    assert((*it | 0x20) == 'e');
+    ++it;
+
+    bool is_negative = false;
+    if (*it == '+' || *it == '-') {
+      is_negative = (*it == '-');
+      ++it;
+    }
+
+    // Large enough to be zero or infinite whatever the significand is.
+    constexpr int64_t EXPONENT_LIMIT = 0x10000;
+    int64_t exponent = 0;
+    for (; it != p_end; ++it) {
+      if (*it != '_' && exponent < EXPONENT_LIMIT)
+        exponent = exponent * 10 + (*it - '0');
     }
 
-    *it++ = *p_begin++;
+    decimal.exponent += is_negative ? -exponent : exponent;
+  }
+
+  return decimal;
+}
+
+struct PUInt128
+{
+  uint64_t low;
+  uint64_t high;
+};
+
+static inline PUInt128
+full_multiplication(uint64_t p_a, uint64_t p_b)
+{
+#ifdef __SIZEOF_INT128__
+  const unsigned __int128 product = static_cast<unsigned __int128>(p_a) * p_b;
+  return { static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64) };
+#else
+  const uint64_t a_low = p_a & 0xFFFFFFFF, a_high = p_a >> 32;
+  const uint64_t b_low = p_b & 0xFFFFFFFF, b_high = p_b >> 32;
+  const uint64_t low_low = a_low * b_low;
+  const uint64_t high_low = a_high * b_low;
+  const uint64_t low_high = a_low * b_high;
+  const uint64_t high_high = a_high * b_high;
+  const uint64_t middle = (low_low >> 32) + (high_low & 0xFFFFFFFF) + low_high;
+  return { (middle << 32) | (low_low & 0xFFFFFFFF), high_high + (high_low >> 32) + (middle >> 32) };
+#endif
+}
+
+// The 128-bit approximations of 5^q, two 64-bit words per power.
+static constexpr int g_smallest_power_of_five = -342;
+static constexpr uint64_t g_powers_of_five[] = {
+#define POWER_OF_FIVE(p_high, p_low) p_high, p_low,
+#include "power_of_five.def"
+};
+
+/// Returns the most significant bits of p_w * 5^p_q, precise at least on
+/// the P_BIT_PRECISION most significant bits.
+template<int P_BIT_PRECISION>
+static inline PUInt128
+compute_product_approximation(int64_t p_q, uint64_t p_w)
+{
+  const size_t index = 2 * static_cast<size_t>(p_q - g_smallest_power_of_five);
+  constexpr uint64_t PRECISION_MASK = UINT64_MAX >> P_BIT_PRECISION;
+
+  PUInt128 product = full_multiplication(p_w, g_powers_of_five[index]);
+  // Only look at the low word of the power if the bits we need may change.
+  if ((product.high & PRECISION_MASK) == PRECISION_MASK) {
+    const PUInt128 second_product = full_multiplication(p_w, g_powers_of_five[index + 1]);
+    product.low += second_product.high;
+    if (second_product.high > product.low)
+      ++product.high;
+  }
+
+  return product;
+}
+
+/// Returns floor(log2(10^p_q)) + 63.
+static inline int
+power_of_ten_to_power_of_two(int p_q)
+{
+  return (((152170 + 65536) * p_q) >> 16) + 63;
+}
+
+/// A binary float being built: mantissa (without the implicit bit) and biased
+/// exponent, i.e. the raw fields of the IEEE 754 encoding.
+struct PAdjustedMantissa
+{
+  uint64_t mantissa;
+  int power2;
+};
+
+/// Converts p_w * 10^p_q to the nearest float of format T (ties to even).
+template<class T>
+static PAdjustedMantissa
+compute_float(int64_t p_q, uint64_t p_w)
+{
+  using PFormat = PBinaryFormat<T>;
+
+  if (p_w == 0 || p_q < PFormat::SMALLEST_POWER_OF_TEN)
+    return { 0, 0 };
+  if (p_q > PFormat::LARGEST_POWER_OF_TEN)
+    return { 0, PFormat::INFINITE_POWER };
+
+  // Normalize p_w so that its most significant bit is set.
+  const int leading_zeros = std::countl_zero(p_w);
+  p_w <<= leading_zeros;
+
+  // The product must be exact on the mantissa bits, plus the implicit bit, a
+  // rounding bit and a bit possibly lost if the product is too small. This
+  // approximation is always sufficient (Mushtak and Lemire, "Fast Number
+  // Parsing Without Fallback").
+  const PUInt128 product = compute_product_approximation<PFormat::MANTISSA_BITS + 3>(p_q, p_w);
+  const int upper_bit = static_cast<int>(product.high >> 63);
+  const int shift = upper_bit + 64 - PFormat::MANTISSA_BITS - 3;
+
+  PAdjustedMantissa answer;
+  answer.mantissa = product.high >> shift;
+  answer.power2 = power_of_ten_to_power_of_two(static_cast<int>(p_q)) + upper_bit - leading_zeros -
+                  PFormat::MINIMUM_EXPONENT;
+
+  if (answer.power2 <= 0) { // subnormal
+    if (-answer.power2 + 1 >= 64)
+      return { 0, 0 };
+
+    answer.mantissa >>= -answer.power2 + 1;
+    answer.mantissa += (answer.mantissa & 1); // round up
+    answer.mantissa >>= 1;
+    // Rounding up may give the smallest normal number.
+    answer.power2 = (answer.mantissa < (uint64_t(1) << PFormat::MANTISSA_BITS)) ? 0 : 1;
+    return answer;
+  }
+
+  // If the value is exactly halfway between two floats, round to even
+  // instead of up. This can only happen for small powers of ten.
+  if (product.low <= 1 && p_q >= PFormat::MIN_EXPONENT_ROUND_TO_EVEN &&
+      p_q <= PFormat::MAX_EXPONENT_ROUND_TO_EVEN && (answer.mantissa & 3) == 1) {
+    if ((answer.mantissa << shift) == product.high)
+      answer.mantissa &= ~uint64_t(1);
+  }
+
+  answer.mantissa += (answer.mantissa & 1); // round up
+  answer.mantissa >>= 1;
+  if (answer.mantissa >= (uint64_t(2) << PFormat::MANTISSA_BITS)) {
+    answer.mantissa = uint64_t(1) << PFormat::MANTISSA_BITS;
+    ++answer.power2;
+  }
+
+  answer.mantissa &= ~(uint64_t(1) << PFormat::MANTISSA_BITS);
+  if (answer.power2 >= PFormat::INFINITE_POWER)
+    return { 0, PFormat::INFINITE_POWER };
+
+  return answer;
+}
+
+/// Converts the float literal [p_begin, p_end) with strtod() or strtof(),
+/// after removing the digit separators.
+template<class T>
+static T
+parse_float_literal_slow(const char* p_begin, const char* p_end)
+{
+  std::string buffer;
+  buffer.reserve(p_end - p_begin);
+  for (; p_begin != p_end; ++p_begin) {
+    if (*p_begin != '_')
+      buffer.push_back(*p_begin);
   }
-  *it = '\0';
 
   // This expects that the current locale is the "C" locale (this is set by the driver).
-  // TODO: Maybe find a better way to parse float literals.
-  errno = 0;
-  p_value = strtod(buffer, nullptr);
-  bool too_big = (errno == ERANGE);
+  return PBinaryFormat<T>::parse_slow(buffer.c_str());
+}
+
+template<class T>
+static bool
+parse_float_literal_helper(const char* p_begin, const char* p_end, T& p_value)
+{
+  using PFormat = PBinaryFormat<T>;
+
+  assert(p_begin != nullptr && p_begin != p_end);
+
+  const PDecimal decimal = parse_decimal(p_begin, p_end);
+
+#if FLT_EVAL_METHOD == 0
+  if (!decimal.truncated && decimal.exponent >= -PFormat::MAX_EXACT_POWER_OF_TEN &&
+      decimal.exponent <= PFormat::MAX_EXACT_POWER_OF_TEN && decimal.significand <= PFormat::MAX_EXACT_SIGNIFICAND) {
+    constexpr T POWERS_OF_TEN[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    p_value = static_cast<T>(decimal.significand);
+    if (decimal.exponent < 0)
+      p_value /= POWERS_OF_TEN[-decimal.exponent];
+    else
+      p_value *= POWERS_OF_TEN[decimal.exponent];
+    return false;
+  }
+#endif
+
+  PAdjustedMantissa answer = compute_float<T>(decimal.exponent, decimal.significand);
+  if (decimal.truncated) {
+    // Both bounds of the value must give the same float, otherwise we need
+    // all the digits.
+    const PAdjustedMantissa upper = compute_float<T>(decimal.exponent, decimal.significand + 1);
+    if (answer.mantissa != upper.mantissa || answer.power2 != upper.power2) {
+      p_value = parse_float_literal_slow<T>(p_begin, p_end);
+      return std::isinf(p_value);
+    }
+  }
 
-  free(buffer);
-  return too_big;
+  const auto bits = static_cast<typename PFormat::PBits>(
+    answer.mantissa | (static_cast<uint64_t>(answer.power2) << PFormat::MANTISSA_BITS));
+  p_value = std::bit_cast<T>(bits);
+  return answer.power2 == PFormat::INFINITE_POWER;
+}
+
+bool
+parse_float_literal_token(const char* p_begin, const char* p_end, double& p_value)
+{
+  return parse_float_literal_helper(p_begin, p_end, p_value);
+}
+
+bool
+parse_float_literal_token(const char* p_begin, const char* p_end, float& p_value)
+{
+  return parse_float_literal_helper(p_begin, p_end, p_value);
 }
 
 // Checks if it is a valid Unicode codepoint.
@@ -292,3 +692,17 @@ parse_string_literal_token(const char* p_begin, const char* p_end)
   assert(*p_begin == '"');
   return buffer;
 }
+
+std::string_view
+parse_string_literal_token(const char* p_begin, const char* p_end, std::string& p_buffer)
+{
+  assert(p_begin != nullptr && p_end - p_begin >= 2 && *p_begin == '"' && p_end[-1] == '"');
+
+  const char* content_begin = p_begin + 1;
+  const char* content_end = p_end - 1;
+  if (p_find_any_of(content_begin, content_end, "\\") == content_end)
+    return { content_begin, static_cast<size_t>(content_end - content_begin) };
+
+  p_buffer = parse_string_literal_token(p_begin, p_end);
+  return p_buffer;
+}
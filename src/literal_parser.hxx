@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 // This file contains a set of functions that allows to extract the value
 // of the literal returned by the lexical analyzer (this one just returns two
@@ -33,11 +34,18 @@ parse_int_literal_token(const char* p_begin, const char* p_end, int p_radix, uin
 /// as tokenized by the lexer. However, the final floating-point suffix (e.g. 'f32')
 /// must not be included.
 ///
+/// The result is correctly rounded (to nearest, ties to even).
+///
 /// Returns true if the parsed value is too big to hold in p_value, otherwise
 /// returns false. If true is returned, the returned is undefined.
 bool
 parse_float_literal_token(const char* p_begin, const char* p_end, double& p_value);
 
+/// Same as above but rounds directly to single precision, which is not the
+/// same as converting the double precision value (it may round twice).
+bool
+parse_float_literal_token(const char* p_begin, const char* p_end, float& p_value);
+
 /// Parse a string literal resolving all escape sequences.
 ///
 /// The input is expected to exactly represents a valid string literal as
@@ -49,4 +57,11 @@ parse_float_literal_token(const char* p_begin, const char* p_end, double& p_valu
 std::string
 parse_string_literal_token(const char* p_begin, const char* p_end);
 
+/// Same as above, but does not copy the literal when it has no escape
+/// sequence (the common case): the returned view then points into
+/// [p_begin, p_end). Otherwise, the value is built into p_buffer and the
+/// returned view points into it.
+std::string_view
+parse_string_literal_token(const char* p_begin, const char* p_end, std::string& p_buffer);
+
 #endif // PEONY_LITERAL_PARSER_HXX
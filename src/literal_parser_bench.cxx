@@ -0,0 +1,97 @@
+#include "literal_parser.hxx"
+
+#include <benchmark/benchmark.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+/// The previous implementation of parse_float_literal_token(), used as a
+/// baseline: copy the literal without digit separators then call strtod().
+static bool
+parse_float_literal_strtod(const char* p_begin, const char* p_end, double& p_value)
+{
+  const size_t buffer_size = sizeof(char) * (p_end - p_begin + 1 /* NUL-terminated */);
+  char* buffer = static_cast<char*>(malloc(buffer_size));
+
+  char* it = buffer;
+  while (p_begin != p_end) {
+    if (*p_begin == '_') {
+      ++p_begin;
+      continue;
+    }
+
+    *it++ = *p_begin++;
+  }
+  *it = '\0';
+
+  errno = 0;
+  p_value = strtod(buffer, nullptr);
+  bool too_big = (errno == ERANGE);
+
+  free(buffer);
+  return too_big;
+}
+
+/// Returns p_count random float literals, as found in numeric tables: a few
+/// integer digits, up to 17 fractional digits and sometimes an exponent.
+static std::vector<std::string>
+generate_float_literals(size_t p_count)
+{
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> distribution(0.0, 1000.0);
+
+  std::vector<std::string> literals;
+  literals.reserve(p_count);
+  char buffer[64];
+  for (size_t i = 0; i < p_count; ++i) {
+    const int precision = static_cast<int>(rng() % 18);
+    if (rng() % 4 == 0)
+      snprintf(buffer, sizeof(buffer), "%.*e", precision, distribution(rng));
+    else
+      snprintf(buffer, sizeof(buffer), "%.*f", precision, distribution(rng));
+    literals.emplace_back(buffer);
+  }
+
+  return literals;
+}
+
+template<class Parser>
+static void
+run_float_benchmark(benchmark::State& p_state, Parser p_parser)
+{
+  const auto literals = generate_float_literals(10000);
+  size_t bytes = 0;
+  for (const auto& literal : literals)
+    bytes += literal.size();
+
+  for (auto _ : p_state) {
+    for (const auto& literal : literals) {
+      double value;
+      p_parser(literal.data(), literal.data() + literal.size(), value);
+      benchmark::DoNotOptimize(value);
+    }
+  }
+
+  p_state.SetItemsProcessed(p_state.iterations() * literals.size());
+  p_state.SetBytesProcessed(p_state.iterations() * bytes);
+}
+
+static void
+BM_parse_float_literal(benchmark::State& p_state)
+{
+  run_float_benchmark(p_state, [](const char* p_begin, const char* p_end, double& p_value) {
+    return parse_float_literal_token(p_begin, p_end, p_value);
+  });
+}
+BENCHMARK(BM_parse_float_literal);
+
+static void
+BM_parse_float_literal_strtod(benchmark::State& p_state)
+{
+  run_float_benchmark(p_state, parse_float_literal_strtod);
+}
+BENCHMARK(BM_parse_float_literal_strtod);
@@ -18,6 +18,13 @@ TEST(literal_parser, dec_int_literal)
   check("0", 0);
   check("42", 42);
   check("1_000_000", 1000000);
+  // Long enough to be converted 8 digits at a time.
+  check("12345678", 12345678);
+  check("1234567890123", 1234567890123);
+  check("1_234_567_890_123_456", 1234567890123456);
+  check("00000000000000000000000042", 42);
+  check("18446744073709551615", UINTMAX_MAX);
+  check_overflow("18446744073709551616");
   check_overflow("9999999999999999999999999999");
 }
 
@@ -77,6 +84,12 @@ TEST(literal_parser, hex_int_literal)
   check("0x10", 16);
   check("0XAf", 175);
   check("0x5A_2f_3D", 5910333);
+  // Long enough to be converted 8 digits at a time.
+  check("0x0123456789abcdef", 0x0123456789abcdef);
+  check("0xFEDCBA9876543210", 0xFEDCBA9876543210);
+  check("0xDEAD_BEEF_cafe_f00d", 0xDEADBEEFCAFEF00D);
+  check("0x000000000000000000ff", 0xff);
+  check_overflow("0x1_0000_0000_0000_0000");
   check_overflow("0xffffffffffffffffffffff");
 }
 
@@ -98,7 +111,56 @@ TEST(literal_parser, float_literal)
   EXPECT_EQ(get_value("0.0"), 0.0);
   EXPECT_EQ(get_value("19.254"), 19.254);
   EXPECT_EQ(get_value("1.18973e+32"), 1.18973e+32);
+  EXPECT_EQ(get_value("1_000.000_5"), 1000.0005);
+  EXPECT_EQ(get_value("1e1_0"), 1e10);
+  EXPECT_EQ(get_value("1E-3"), 1e-3);
+  EXPECT_EQ(get_value("0_0.0_1"), 0.01);
+  EXPECT_EQ(get_value("0e1000"), 0.0);
+  // Exactly halfway between two doubles, rounded to even.
+  EXPECT_EQ(get_value("9007199254740993"), 9007199254740992.0);
+  EXPECT_EQ(get_value("9007199254740993.000000000000000000001"), 9007199254740994.0);
+  // More significant digits than fit in 64 bits.
+  EXPECT_EQ(get_value("3.14159265358979323846264338327950288"), 3.14159265358979323846264338327950288);
+  EXPECT_EQ(get_value("123456789012345678901234567890e-10"), 123456789012345678901234567890e-10);
+  // Subnormals and limits.
+  EXPECT_EQ(get_value("2.2250738585072011e-308"), 2.2250738585072011e-308);
+  EXPECT_EQ(get_value("4.9406564584124654e-324"), 4.9406564584124654e-324);
+  EXPECT_EQ(get_value("1e-400"), 0.0);
+  EXPECT_EQ(get_value("1.7976931348623157e308"), 1.7976931348623157e308);
+  EXPECT_TRUE(does_overflow("1.7976931348623159e308"));
   EXPECT_TRUE(does_overflow("1.18973e+4932"));
+  EXPECT_TRUE(does_overflow("1e99999999999999999999"));
+}
+
+TEST(literal_parser, f32_literal)
+{
+  auto does_overflow = [](const char* p_input) {
+    const char* end = p_input + strlen(p_input);
+    float value;
+    return parse_float_literal_token(p_input, end, value);
+  };
+
+  auto get_value = [](const char* p_input) {
+    const char* end = p_input + strlen(p_input);
+    float value;
+    EXPECT_FALSE(parse_float_literal_token(p_input, end, value));
+    return value;
+  };
+
+  EXPECT_EQ(get_value("0.0"), 0.0f);
+  EXPECT_EQ(get_value("19.254"), 19.254f);
+  EXPECT_EQ(get_value("1_0.2_5e1"), 102.5f);
+  EXPECT_EQ(get_value("1.4e-45"), 1.4e-45f);
+  EXPECT_EQ(get_value("3.4028235e38"), 3.4028235e38f);
+  EXPECT_TRUE(does_overflow("3.4028236e38"));
+
+  // Just above the halfway point between 1 and the next float. Rounding it
+  // to double first gives exactly the halfway point, which then rounds down.
+  const char* input = "1.000000059604644775390626";
+  double double_value;
+  parse_float_literal_token(input, input + strlen(input), double_value);
+  EXPECT_EQ(static_cast<float>(double_value), 1.0f);
+  EXPECT_EQ(get_value(input), 1.00000011920928955078125f);
 }
 
 TEST(literal_parser, string_literal)
@@ -113,3 +175,24 @@ TEST(literal_parser, string_literal)
   check(R"("\x7f\x2A")", "\x7f\x2A");
   check(R"("\u{1}\u{4f}\u{7a2}\u{aBCd}\u{10ffff}")", "\x01\x4f\xde\xa2\xea\xaf\x8d\xf4\x8f\xbf\xbf");
 }
+
+TEST(literal_parser, string_literal_view)
+{
+  std::string buffer;
+
+  // Without escape sequences, the value points into the literal.
+  const std::string input = "\"" + std::string(100, 'a') + "\"";
+  const auto value = parse_string_literal_token(input.data(), input.data() + input.size(), buffer);
+  EXPECT_EQ(value, std::string(100, 'a'));
+  EXPECT_EQ(value.data(), input.data() + 1);
+  EXPECT_TRUE(buffer.empty());
+
+  const char* empty = R"("")";
+  EXPECT_EQ(parse_string_literal_token(empty, empty + 2, buffer), "");
+
+  // Otherwise, it is built into the buffer.
+  const std::string escaped = "\"" + std::string(40, 'a') + "\\n\"";
+  const auto escaped_value = parse_string_literal_token(escaped.data(), escaped.data() + escaped.size(), buffer);
+  EXPECT_EQ(escaped_value, std::string(40, 'a') + "\n");
+  EXPECT_EQ(escaped_value.data(), buffer.data());
+}
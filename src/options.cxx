@@ -4,7 +4,12 @@ POptions g_options = {
 #define OPTION(p_opt, p_var) .p_var = false,
 #define FEATURE_OPTION_SWITCH(p_opt, p_var, p_default) .p_var = (p_default),
 #define FEATURE_OPTION_INT(p_opt, p_var, p_default) .p_var = (p_default),
+#define FEATURE_OPTION_STRING(p_opt, p_var, p_default) .p_var = (p_default),
 #include "options.def"
 
+  .opt_optimization_level = P_OPT_O0,
+  .opt_emit = P_EMIT_EXECUTABLE,
+  .opt_lto = P_LTO_NONE,
+  .opt_jobs = 1,
   .output_file = nullptr,
 };
@@ -5,23 +5,39 @@
 
 typedef enum POptimizationLevel
 {
-  P_OPT_O,
-  P_OPT_O0,
-  P_OPT_O1,
-  P_OPT_O2,
-  P_OPT_O3,
-  P_OPT_Oz,
-  P_OPT_Os
+#define OPTIMIZATION_LEVEL(p_name, p_level) P_OPT_##p_level,
+#include "options.def"
 } POptimizationLevel;
 
+/// The kind of artifact produced by the compiler.
+typedef enum PEmitKind
+{
+  P_EMIT_EXECUTABLE,
+#define EMIT_KIND(p_opt, p_kind, p_extension) P_EMIT_##p_kind,
+#include "options.def"
+} PEmitKind;
+
+/// The link-time optimization mode (-flto).
+typedef enum PLtoMode
+{
+  P_LTO_NONE,
+  P_LTO_FULL,
+  P_LTO_THIN,
+} PLtoMode;
+
 typedef struct POptions
 {
 #define OPTION(p_opt, p_var) bool p_var;
 #define FEATURE_OPTION_SWITCH(p_opt, p_var, p_default) bool p_var;
 #define FEATURE_OPTION_INT(p_opt, p_var, p_default) int p_var;
+#define FEATURE_OPTION_STRING(p_opt, p_var, p_default) const char* p_var;
 #include "options.def"
 
   POptimizationLevel opt_optimization_level;
+  PEmitKind opt_emit;
+  PLtoMode opt_lto;
+  // Count of translation units compiled concurrently (-j N), 0 means one per hardware thread.
+  int opt_jobs;
 
   const char* output_file;
   std::vector<std::string> input_files;
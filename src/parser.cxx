@@ -4,6 +4,7 @@
 #include "scope.hxx"
 
 #include "utils/diag.hxx"
+#include "utils/time_trace.hxx"
 
 #include <cassert>
 #include <vector>
@@ -20,12 +21,14 @@ public:
   void consume_open()
   {
     assert(m_parser.lookahead(m_open_token));
+    m_open_location = m_parser.m_token.source_location;
     m_parser.consume_token();
   }
 
   void consume_close()
   {
     assert(m_parser.lookahead(get_close_token()));
+    m_close_location = m_parser.m_token.source_location;
     m_parser.consume_token();
   }
 
@@ -114,7 +117,14 @@ private:
 
 PParser::PParser(PContext& p_context, PLexer& p_lexer)
   : m_context(p_context)
-  , m_lexer(p_lexer)
+  , m_lexer(&p_lexer)
+  , m_sema(p_context)
+{
+}
+
+PParser::PParser(PContext& p_context, const PTokenBuffer& p_token_buffer)
+  : m_context(p_context)
+  , m_token_buffer(&p_token_buffer)
   , m_sema(p_context)
 {
 }
@@ -569,10 +579,9 @@ PParser::parse_int_lit()
 
   PSourceRange range = get_token_range();
 
-  uintmax_t value;
-  const bool overflow = parse_int_literal_token(
-    m_token.data.literal.begin, m_token.data.literal.end, m_token.data.literal.int_radix, value);
-  if (overflow) {
+  // The value is computed by the lexer.
+  uintmax_t value = m_token.data.literal.int_value;
+  if (m_token.data.literal.int_overflow) {
     PDiag* d = diag_at(P_DK_err_generic_int_literal_too_large, range.begin);
     diag_add_source_range(d, range);
     diag_flush(d);
@@ -593,8 +602,18 @@ PParser::parse_float_lit()
 
   PSourceRange range = get_token_range();
 
+  const auto suffix = static_cast<PFloatLiteralSuffix>(m_token.data.literal.suffix_kind);
+
   double value;
-  const bool overflow = parse_float_literal_token(m_token.data.literal.begin, m_token.data.literal.end, value);
+  bool overflow;
+  if (suffix == P_FLS_F32) {
+    float f32_value;
+    overflow = parse_float_literal_token(m_token.data.literal.begin, m_token.data.literal.end, f32_value);
+    value = f32_value;
+  } else {
+    overflow = parse_float_literal_token(m_token.data.literal.begin, m_token.data.literal.end, value);
+  }
+
   if (overflow) {
     PDiag* d = diag_at(P_DK_err_generic_float_literal_too_large, range.begin);
     diag_add_source_range(d, range);
@@ -602,7 +621,6 @@ PParser::parse_float_lit()
     value = 0.0; // set a default value to recover
   }
 
-  const auto suffix = static_cast<PFloatLiteralSuffix>(m_token.data.literal.suffix_kind);
   consume_token();
   return m_sema.act_on_float_literal(value, suffix, range);
 }
@@ -1030,24 +1048,22 @@ PParser::parse_extern_decl()
 
   consume_token(); // consume 'extern'
 
-  std::string abi;
+  std::string_view abi;
   PSourceRange abi_range;
   bool has_abi = lookahead(P_TOK_STRING_LITERAL);
   if (has_abi) {
-    abi = parse_string_literal_token(m_token.data.literal.begin, m_token.data.literal.end);
+    std::string buffer;
+    abi = m_context.intern_string(
+      parse_string_literal_token(m_token.data.literal.begin, m_token.data.literal.end, buffer));
     abi_range = get_token_range();
     consume_token();
   }
 
   if (lookahead(P_TOK_KEY_fn)) {
-    char* copied_abi = m_context.alloc_object<char>(abi.size() + 1);
-    std::copy(abi.begin(), abi.end(), copied_abi);
-    copied_abi[abi.size()] = '\0';
-
     PFunctionDecl* func_decl = parse_func_decl(true);
     func_decl->set_extern(true);
     if (has_abi) {
-      func_decl->set_abi(std::string_view(copied_abi, abi.size()));
+      func_decl->set_abi(abi);
       m_sema.check_func_abi(func_decl->get_abi(), abi_range);
     }
 
@@ -1148,17 +1164,27 @@ PParser::parse_struct_decl()
 PDecl*
 PParser::parse_top_level_decl()
 {
+  PTimeTraceScope trace_scope("Parse TopLevelDecl");
+
+  PDecl* decl;
   switch (m_token.kind) {
     case P_TOK_KEY_extern:
-      return parse_extern_decl();
+      decl = parse_extern_decl();
+      break;
     case P_TOK_KEY_fn:
-      return parse_func_decl();
+      decl = parse_func_decl();
+      break;
     case P_TOK_KEY_struct:
-      return parse_struct_decl();
+      decl = parse_struct_decl();
+      break;
     default:
       unexpected_token();
       return nullptr;
   }
+
+  if (decl != nullptr && decl->get_name() != nullptr)
+    trace_scope.set_detail(decl->get_name()->get_spelling());
+  return decl;
 }
 
 // translation_unit:
@@ -1180,7 +1206,7 @@ PParser::parse_translation_unit()
 
   auto* node = m_sema.act_on_translation_unit(decls);
   node->set_source_range(range_tracker.get_source_range());
-  node->p_src_file = m_lexer.source_file;
+  node->p_src_file = m_token_buffer != nullptr ? m_token_buffer->get_source_file() : m_lexer->source_file;
   m_sema.pop_scope();
   return node;
 }
@@ -1222,7 +1248,10 @@ void
 PParser::consume_token()
 {
   m_prev_lookahead_end_loc = m_token.source_location + m_token.token_length;
-  m_lexer.tokenize(m_token);
+  if (m_token_buffer != nullptr)
+    m_token_buffer->get_token(m_token_index++, m_token);
+  else
+    m_lexer->tokenize(m_token);
 }
 
 bool
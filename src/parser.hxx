@@ -5,11 +5,14 @@
 #include "context.hxx"
 #include "lexer.hxx"
 #include "sema.hxx"
+#include "token_buffer.hxx"
 
 class PParser
 {
 public:
   PParser(PContext& p_context, PLexer& p_lexer);
+  /// Parses the tokens of p_token_buffer instead of pulling them from a lexer.
+  PParser(PContext& p_context, const PTokenBuffer& p_token_buffer);
   ~PParser();
 
   [[nodiscard]] bool lookahead(PTokenKind p_kind) const { return m_token.kind == p_kind; }
@@ -18,6 +21,8 @@ public:
   PAst* parse_standalone_stmt();
   PAstExpr* parse_standalone_expr();
 
+  [[nodiscard]] const PSema& get_sema() const { return m_sema; }
+
 private:
   PAst* parse_stmt();
   PAstExpr* parse_expr();
@@ -102,7 +107,11 @@ private:
 
 private:
   PContext& m_context;
-  PLexer& m_lexer;
+  // Exactly one of m_lexer and m_token_buffer is set.
+  PLexer* m_lexer = nullptr;
+  const PTokenBuffer* m_token_buffer = nullptr;
+  // The index of the next token to consume from m_token_buffer.
+  size_t m_token_index = 0;
   PSema m_sema;
 
   // The token actually considered by the parser.
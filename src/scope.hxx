@@ -2,9 +2,9 @@
 #define PEONY_SCOPE_HXX
 
 #include "identifier_table.hxx"
+#include "utils/hash_map.hxx"
 
-#include <unordered_map>
-
+class PContext;
 class PDecl;
 class PAst;
 
@@ -36,7 +36,7 @@ struct PScope
 {
   PScope* parent_scope;
   PAst* statement; /* statement at origin of this scope (PAstWhileStmt, PAstCompoundStmt, etc.) */
-  std::unordered_map<PIdentifierInfo*, PSymbol*> symbols;
+  PHashMap<PIdentifierInfo*, PSymbol*> symbols;
   PScopeFlags flags;
 
   PScope(PScope* p_parent_scope, PScopeFlags p_flags = P_SF_NONE);
@@ -45,7 +45,8 @@ struct PScope
 PSymbol*
 p_scope_local_lookup(PScope* p_scope, PIdentifierInfo* p_name);
 
+/// Creates a new symbol in the given scope. The symbol is allocated in p_ctx.
 PSymbol*
-p_scope_add_symbol(PScope* p_scope, PIdentifierInfo* p_name);
+p_scope_add_symbol(PContext& p_ctx, PScope* p_scope, PIdentifierInfo* p_name);
 
 #endif // PEONY_SCOPE_HXX
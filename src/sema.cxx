@@ -36,6 +36,9 @@ PSema::pop_scope()
 {
   assert(m_current_scope != nullptr);
 
+  m_scope_memory_usage.bytes += sizeof(PScope) + m_current_scope->symbols.get_memory_usage();
+  m_scope_memory_usage.count += 1;
+
   PScope* parent = m_current_scope->parent_scope;
   delete m_current_scope;
   m_current_scope = parent;
@@ -906,7 +909,7 @@ PSema::act_on_var_decl(PType* p_type, PLocalizedIdentifierInfo p_name, PAstExpr*
   auto* node = m_context.new_object<PVarDecl>(p_type, p_name, p_init_expr, p_src_range);
 
   if (symbol == nullptr) {
-    symbol = p_scope_add_symbol(m_current_scope, p_name.ident);
+    symbol = p_scope_add_symbol(m_context, m_current_scope, p_name.ident);
     symbol->decl = node;
   }
 
@@ -943,7 +946,7 @@ PSema::act_on_param_decl(PType* p_type, PLocalizedIdentifierInfo p_name, PSource
   auto* node = m_context.new_object<PParamDecl>(p_type, p_name, p_src_range);
 
   if (symbol == nullptr) {
-    symbol = p_scope_add_symbol(m_current_scope, p_name.ident);
+    symbol = p_scope_add_symbol(m_context, m_current_scope, p_name.ident);
     symbol->decl = node;
   }
 
@@ -962,7 +965,7 @@ PSema::begin_func_decl_analysis(PFunctionDecl* p_decl)
   for (auto param : p_decl->params) {
     // We are tolerant for nullptrs to try recover errors during parsing.
     if (param != nullptr && param->get_name() != nullptr) {
-      PSymbol* symbol = p_scope_add_symbol(m_current_scope, param->get_name());
+      PSymbol* symbol = p_scope_add_symbol(m_context, m_current_scope, param->get_name());
       symbol->decl = param;
     }
   }
@@ -1020,7 +1023,7 @@ PSema::act_on_func_decl(PLocalizedIdentifierInfo p_name,
   auto* decl = m_context.new_object<PFunctionDecl>(func_ty, p_name, make_array_view_copy(p_params));
 
   if (symbol == nullptr) {
-    symbol = p_scope_add_symbol(m_current_scope, p_name.ident);
+    symbol = p_scope_add_symbol(m_context, m_current_scope, p_name.ident);
     symbol->decl = decl;
   }
 
@@ -1080,7 +1083,7 @@ PSema::act_on_struct_decl(PLocalizedIdentifierInfo p_name,
   auto* decl = m_context.new_object<PStructDecl>(m_context, p_name, make_array_view_copy(p_fields), p_src_range);
 
   if (symbol == nullptr) {
-    symbol = p_scope_add_symbol(m_current_scope, p_name.ident);
+    symbol = p_scope_add_symbol(m_context, m_current_scope, p_name.ident);
     symbol->decl = decl;
   }
 
@@ -24,6 +24,11 @@ public:
   void push_scope(PScopeFlags p_flags = P_SF_NONE);
   void pop_scope();
 
+  /// Returns the memory allocated by all the scopes popped so far (for
+  /// -fmem-report). The scopes are freed when popped, except their symbols
+  /// which are allocated in the context.
+  [[nodiscard]] PMemRecord get_scope_memory_usage() const { return m_scope_memory_usage; }
+
   [[nodiscard]] PSymbol* lookup(PIdentifierInfo* p_name) const;
   [[nodiscard]] PSymbol* local_lookup(PIdentifierInfo* p_name) const;
 
@@ -189,6 +194,7 @@ private:
   PContext& m_context;
   PScope* m_current_scope = nullptr;
   PFunctionType* m_curr_func_type;
+  PMemRecord m_scope_memory_usage;
 };
 
 #endif // PEONY_SEMA_HXX
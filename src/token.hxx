@@ -4,6 +4,8 @@
 #include "token_kind.hxx"
 #include "utils/source_location.hxx"
 
+#include <cstdint>
+
 class PIdentifierInfo;
 
 /// The different possible integer literal suffixes.
@@ -32,10 +34,17 @@ struct PTokenLiteralData
 {
   // The radix of the integer literal (either 2, 8, 10 or 16).
   // This value is undefined for tokens other than P_TOK_INT_LITERAL.
-  int int_radix;
+  uint8_t int_radix;
   // Either a value of PIntLiteralSuffix or PFloatLiteralSuffix depending
   // on the token m_kind.
-  int suffix_kind;
+  uint8_t suffix_kind;
+  // True if the value of the integer literal does not fit in int_value.
+  // This value is undefined for tokens other than P_TOK_INT_LITERAL.
+  bool int_overflow;
+  // The value of the integer literal, computed by the lexer while the
+  // literal is still hot in cache. This value is undefined for tokens other
+  // than P_TOK_INT_LITERAL or if int_overflow is true.
+  uint64_t int_value;
   // begin and end are pointers to the source file m_buffer used
   // by the lexer and therefore their lifetime depends on that of the file.
   // The range [begin, end) does not include any integer or float
@@ -46,7 +55,7 @@ struct PTokenLiteralData
 
 union PTokenData
 {
-  // This field is only valid for P_TOK_IDENTIFIER and P_TOK_KEY_* tokens.
+  // This field is only valid for P_TOK_IDENTIFIER tokens.
   PIdentifierInfo* identifier;
   // This field is only valid for P_TOK_*_LITERAL and P_TOK_COMMENT tokens.
   // P_TOK_COMMENT tokens use literal.begin and literal.end to store the
@@ -0,0 +1,204 @@
+#include "token_buffer.hxx"
+
+#include "utils/hash_map.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <thread>
+
+// Used to estimate the number of tokens of a source file to reserve the memory
+// in advance.
+#define P_AVERAGE_TOKEN_LENGTH_ESTIMATE 4
+// Files are only lexed concurrently if each thread has at least this many
+// bytes to lex, smaller chunks are not worth starting a thread.
+#define P_PARALLEL_LEXING_MIN_CHUNK_SIZE (1024 * 1024)
+
+static constexpr int g_token_kind_count = 0
+#define TOKEN(kind) +1
+#include "token_kind.def"
+  ;
+static_assert(g_token_kind_count <= UINT8_MAX + 1, "token kinds must fit in a byte");
+
+/// Returns true if the tokens of the given kind have data (an identifier or
+/// a literal) in PToken::data.
+static bool
+has_payload(PTokenKind p_kind)
+{
+  switch (p_kind) {
+#define TOKEN(kind)
+#define PUNCTUATION(kind, spelling) case P_TOK_##kind:
+#define KEYWORD(spelling) case P_TOK_KEY_##spelling:
+#include "token_kind.def"
+    case P_TOK_EOF:
+      return false;
+    default:
+      return true;
+  }
+}
+
+void
+PTokenBuffer::lex_all(PLexer& p_lexer, unsigned p_thread_count)
+{
+  m_source_file = p_lexer.source_file;
+  const auto buffer = m_source_file->get_buffer();
+
+  const size_t max_chunk_count = std::max<size_t>(buffer.size() / P_PARALLEL_LEXING_MIN_CHUNK_SIZE, 1);
+  const auto split_points = PLexer::find_split_points(buffer, (unsigned)std::min<size_t>(p_thread_count, max_chunk_count));
+  if (split_points.empty()) {
+    lex_tokens(p_lexer, buffer.size());
+    return;
+  }
+
+  // The identifier table is not thread-safe, each chunk has its own one. If
+  // the table of p_lexer has a shared table, the chunk tables use it too and
+  // the identifiers of all the chunks are the same. Otherwise, the identifiers
+  // are merged after the lexing (see append_chunk()).
+  PConcurrentIdentifierTable* shared_table = p_lexer.identifier_table->get_shared_table();
+  struct PChunk
+  {
+    uint32_t begin;
+    uint32_t end;
+    PIdentifierTable identifier_table;
+    PTokenBuffer tokens;
+    std::vector<PSourceLocation> unknown_characters;
+
+    PChunk(uint32_t p_begin, uint32_t p_end, PConcurrentIdentifierTable* p_shared_table)
+      : begin(p_begin)
+      , end(p_end)
+      , identifier_table(p_shared_table)
+    {
+    }
+  };
+
+  // Not a vector, the chunks can not be moved.
+  std::deque<PChunk> chunks;
+  for (size_t i = 0; i <= split_points.size(); ++i) {
+    const uint32_t begin = (i == 0) ? 0 : split_points[i - 1];
+    const uint32_t end = (i < split_points.size()) ? split_points[i] : static_cast<uint32_t>(buffer.size());
+    chunks.emplace_back(begin, end, shared_table);
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < chunks.size(); ++i) {
+    threads.emplace_back([&chunk = chunks[i], source_file = m_source_file] {
+      PLexer lexer;
+      lexer.identifier_table = &chunk.identifier_table;
+      lexer.set_source_file(source_file);
+      lexer.set_source_range(chunk.begin, chunk.end);
+      lexer.set_deferred_diagnostics(&chunk.unknown_characters);
+      chunk.tokens.lex_tokens(lexer, chunk.end - chunk.begin);
+    });
+  }
+
+  // The first chunk is lexed by the current thread, directly into this buffer.
+  // Its diagnostics are deferred too: all of them are reported in the order of
+  // the chunks once the threads are joined, like a serial lexing would.
+  p_lexer.set_source_range(chunks[0].begin, chunks[0].end);
+  p_lexer.set_deferred_diagnostics(&chunks[0].unknown_characters);
+  lex_tokens(p_lexer, chunks[0].end);
+  p_lexer.set_deferred_diagnostics(nullptr);
+  // Further calls to tokenize() return EOF, like after a serial lexing.
+  p_lexer.set_source_range(static_cast<uint32_t>(buffer.size()), static_cast<uint32_t>(buffer.size()));
+
+  for (auto& thread : threads)
+    thread.join();
+
+  // The tokens already have absolute source locations, as each chunk lexer
+  // works on the whole buffer. Only the identifiers may have to be merged.
+  for (size_t i = 1; i < chunks.size(); ++i)
+    append_chunk(chunks[i].tokens, shared_table != nullptr ? nullptr : p_lexer.identifier_table);
+
+  for (const auto& chunk : chunks) {
+    for (PSourceLocation location : chunk.unknown_characters)
+      PLexer::report_unknown_character(location);
+  }
+}
+
+void
+PTokenBuffer::lex_tokens(PLexer& p_lexer, size_t p_size)
+{
+  const size_t estimated_count = m_kinds.size() + p_size / P_AVERAGE_TOKEN_LENGTH_ESTIMATE + 1;
+  m_kinds.reserve(estimated_count);
+  m_source_locations.reserve(estimated_count);
+  m_token_lengths.reserve(estimated_count);
+  m_payload_indices.reserve(estimated_count);
+
+  PToken token;
+  do {
+    p_lexer.tokenize(token);
+
+    m_kinds.push_back(static_cast<uint8_t>(token.kind));
+    m_source_locations.push_back(token.source_location);
+    m_token_lengths.push_back(token.token_length);
+
+    if (has_payload(token.kind)) {
+      m_payload_indices.push_back(static_cast<uint32_t>(m_payloads.size()));
+      m_payloads.push_back(token.data);
+    } else {
+      m_payload_indices.push_back(NO_PAYLOAD);
+    }
+  } while (token.kind != P_TOK_EOF);
+}
+
+void
+PTokenBuffer::append_chunk(const PTokenBuffer& p_chunk, PIdentifierTable* p_identifier_table)
+{
+  assert(!m_kinds.empty() && get_kind(m_kinds.size() - 1) == P_TOK_EOF);
+  m_kinds.pop_back();
+  m_source_locations.pop_back();
+  m_token_lengths.pop_back();
+  m_payload_indices.pop_back();
+
+  m_kinds.insert(m_kinds.end(), p_chunk.m_kinds.begin(), p_chunk.m_kinds.end());
+  m_source_locations.insert(m_source_locations.end(), p_chunk.m_source_locations.begin(), p_chunk.m_source_locations.end());
+  m_token_lengths.insert(m_token_lengths.end(), p_chunk.m_token_lengths.begin(), p_chunk.m_token_lengths.end());
+
+  // Each distinct identifier of the chunk is only looked up once.
+  PHashMap<PIdentifierInfo*, PIdentifierInfo*> identifiers;
+  const auto payload_offset = static_cast<uint32_t>(m_payloads.size());
+  m_payloads.reserve(m_payloads.size() + p_chunk.m_payloads.size());
+  m_payload_indices.reserve(m_payload_indices.size() + p_chunk.m_payload_indices.size());
+  for (size_t i = 0; i < p_chunk.m_kinds.size(); ++i) {
+    const uint32_t payload_index = p_chunk.m_payload_indices[i];
+    if (payload_index == NO_PAYLOAD) {
+      m_payload_indices.push_back(NO_PAYLOAD);
+      continue;
+    }
+
+    m_payload_indices.push_back(payload_offset + payload_index);
+    PTokenData data = p_chunk.m_payloads[payload_index];
+    if (p_identifier_table != nullptr && p_chunk.get_kind(i) == P_TOK_IDENTIFIER) {
+      auto [entry, inserted] = identifiers.insert(data.identifier, nullptr);
+      if (inserted)
+        entry->value = p_identifier_table->get(data.identifier->get_spelling(), data.identifier->get_hash());
+      data.identifier = entry->value;
+    }
+
+    m_payloads.push_back(data);
+  }
+}
+
+void
+PTokenBuffer::get_token(size_t p_index, PToken& p_token) const
+{
+  assert(!m_kinds.empty() && "lex_all() not called");
+  if (p_index >= m_kinds.size())
+    p_index = m_kinds.size() - 1; // the EOF token
+
+  p_token.kind = get_kind(p_index);
+  p_token.source_location = m_source_locations[p_index];
+  p_token.token_length = m_token_lengths[p_index];
+
+  const uint32_t payload_index = m_payload_indices[p_index];
+  if (payload_index != NO_PAYLOAD)
+    p_token.data = m_payloads[payload_index];
+}
+
+size_t
+PTokenBuffer::get_memory_usage() const
+{
+  return m_kinds.capacity() * sizeof(uint8_t) + m_source_locations.capacity() * sizeof(PSourceLocation) +
+         m_token_lengths.capacity() * sizeof(uint32_t) + m_payload_indices.capacity() * sizeof(uint32_t) +
+         m_payloads.capacity() * sizeof(PTokenData);
+}
@@ -0,0 +1,67 @@
+#ifndef PEONY_TOKEN_BUFFER_HXX
+#define PEONY_TOKEN_BUFFER_HXX
+
+#include "lexer.hxx"
+
+#include <cstdint>
+#include <vector>
+
+/// All the tokens of a source file, lexed up front (-fprelex).
+///
+/// The tokens are stored as a structure of arrays: one byte for the kind and
+/// 32 bits for the location and the length of each token. The identifiers
+/// and the literal data are stored in a side table, only for the tokens that
+/// have one. The parser then consumes the tokens by index, which makes any
+/// lookahead free.
+class PTokenBuffer
+{
+public:
+  /// Lexes all the tokens of the source file of p_lexer, up to and including
+  /// the EOF token.
+  ///
+  /// Large files are split into chunks lexed concurrently by up to
+  /// p_thread_count threads (see PLexer::find_split_points()). The tokens and
+  /// the diagnostics are the same as when lexing serially. If the identifier
+  /// table of p_lexer has a shared table, the threads get their identifiers
+  /// from it directly; otherwise they are merged afterwards.
+  void lex_all(PLexer& p_lexer, unsigned p_thread_count = 1);
+
+  /// Returns the source file the tokens come from.
+  [[nodiscard]] PSourceFile* get_source_file() const { return m_source_file; }
+
+  /// Returns the number of tokens, including the final EOF token.
+  [[nodiscard]] size_t size() const { return m_kinds.size(); }
+
+  [[nodiscard]] PTokenKind get_kind(size_t p_index) const { return static_cast<PTokenKind>(m_kinds[p_index]); }
+  [[nodiscard]] PSourceLocation get_source_location(size_t p_index) const { return m_source_locations[p_index]; }
+  [[nodiscard]] uint32_t get_token_length(size_t p_index) const { return m_token_lengths[p_index]; }
+
+  /// Rebuilds the token at p_index into p_token. Indexes past the end give
+  /// the EOF token, like the lexer does.
+  void get_token(size_t p_index, PToken& p_token) const;
+
+  /// Returns the count of bytes allocated for the tokens.
+  [[nodiscard]] size_t get_memory_usage() const;
+
+private:
+  /// Appends the tokens returned by p_lexer up to and including EOF. The
+  /// p_size bytes to lex are used to estimate the count of tokens.
+  void lex_tokens(PLexer& p_lexer, size_t p_size);
+  /// Appends the tokens of p_chunk after the last token (which must be an EOF
+  /// token, replaced by p_chunk ones). If p_identifier_table is not nullptr,
+  /// p_chunk was lexed with another table and its identifiers are replaced by
+  /// the ones of p_identifier_table.
+  void append_chunk(const PTokenBuffer& p_chunk, PIdentifierTable* p_identifier_table);
+
+  static constexpr uint32_t NO_PAYLOAD = UINT32_MAX;
+
+  PSourceFile* m_source_file = nullptr;
+  std::vector<uint8_t> m_kinds;
+  std::vector<PSourceLocation> m_source_locations;
+  std::vector<uint32_t> m_token_lengths;
+  // Index in m_payloads of the data of each token, or NO_PAYLOAD.
+  std::vector<uint32_t> m_payload_indices;
+  std::vector<PTokenData> m_payloads;
+};
+
+#endif // PEONY_TOKEN_BUFFER_HXX
@@ -0,0 +1,120 @@
+#include "token_buffer.hxx"
+
+#include "utils/diag.hxx"
+
+#include <gtest/gtest.h>
+
+static const char* const g_input = "fn main() -> i32 {\n"
+                                   "  let x = 0x2A_i32; // comment\n"
+                                   "  let y = 3.14f32;\n"
+                                   "  return x + r#y;\n"
+                                   "}\n";
+
+TEST(token_buffer, same_tokens_as_lexer)
+{
+  PIdentifierTable identifier_table;
+
+  PSourceFile source_file("<test-input>", g_input);
+
+  PLexer lexer;
+  lexer.identifier_table = &identifier_table;
+  lexer.set_source_file(&source_file);
+  PTokenBuffer buffer;
+  buffer.lex_all(lexer);
+  EXPECT_EQ(buffer.get_source_file(), &source_file);
+
+  // Lex the same file again to compare the tokens.
+  lexer.set_source_file(&source_file);
+  size_t index = 0;
+  PToken expected, token;
+  do {
+    lexer.tokenize(expected);
+    buffer.get_token(index, token);
+    EXPECT_EQ(buffer.get_kind(index), expected.kind);
+    ++index;
+
+    EXPECT_EQ(token.kind, expected.kind);
+    EXPECT_EQ(token.source_location, expected.source_location);
+    EXPECT_EQ(token.token_length, expected.token_length);
+    if (token.kind == P_TOK_IDENTIFIER) {
+      EXPECT_EQ(token.data.identifier, expected.data.identifier);
+    } else if (token.kind == P_TOK_INT_LITERAL || token.kind == P_TOK_FLOAT_LITERAL) {
+      EXPECT_EQ(token.data.literal.begin, expected.data.literal.begin);
+      EXPECT_EQ(token.data.literal.end, expected.data.literal.end);
+      EXPECT_EQ(token.data.literal.suffix_kind, expected.data.literal.suffix_kind);
+    }
+  } while (expected.kind != P_TOK_EOF);
+
+  EXPECT_EQ(buffer.size(), index);
+
+  // Reading past the end gives the EOF token.
+  buffer.get_token(index + 10, token);
+  EXPECT_EQ(token.kind, P_TOK_EOF);
+}
+
+/// Lexes p_source_file with p_thread_count threads into p_buffer. Returns the
+/// diagnostics output.
+static std::string
+lex_with_threads(PSourceFile& p_source_file,
+                 PIdentifierTable& p_identifier_table,
+                 unsigned p_thread_count,
+                 PTokenBuffer& p_buffer)
+{
+  FILE* diag_output = tmpfile();
+  const PDiagContext saved_diag_context = g_diag_context;
+  g_diag_context.output = diag_output;
+
+  PLexer lexer;
+  lexer.identifier_table = &p_identifier_table;
+  lexer.set_source_file(&p_source_file);
+  p_buffer.lex_all(lexer, p_thread_count);
+
+  g_diag_context = saved_diag_context;
+  g_current_source_file = nullptr;
+
+  std::string output;
+  rewind(diag_output);
+  char buffer[4096];
+  size_t read_bytes;
+  while ((read_bytes = fread(buffer, sizeof(char), sizeof(buffer), diag_output)) > 0)
+    output.append(buffer, read_bytes);
+  fclose(diag_output);
+  return output;
+}
+
+TEST(token_buffer, parallel_lexing)
+{
+  // Large enough to be split in several chunks, with block comments and
+  // string literals spanning the possible split points.
+  std::string input;
+  for (int i = 0; input.size() < 5 * 1024 * 1024; ++i) {
+    input += "fn f" + std::to_string(i) + "(x: i32) -> i32 { return x + 0x2A; } // \"/*\n";
+    if (i % 1000 == 0)
+      input += "/* a\n block\n comment */ \"str\\\"/*\" $\n";
+  }
+
+  PSourceFile source_file("<test-input>", input);
+  PIdentifierTable serial_identifiers, parallel_identifiers;
+  PTokenBuffer serial, parallel;
+  const auto serial_diags = lex_with_threads(source_file, serial_identifiers, 1, serial);
+  const auto parallel_diags = lex_with_threads(source_file, parallel_identifiers, 4, parallel);
+
+  EXPECT_FALSE(serial_diags.empty());
+  EXPECT_EQ(serial_diags, parallel_diags);
+
+  ASSERT_EQ(serial.size(), parallel.size());
+  PToken expected, token;
+  for (size_t i = 0; i < serial.size(); ++i) {
+    serial.get_token(i, expected);
+    parallel.get_token(i, token);
+    ASSERT_EQ(token.kind, expected.kind);
+    ASSERT_EQ(token.source_location, expected.source_location);
+    ASSERT_EQ(token.token_length, expected.token_length);
+    if (token.kind == P_TOK_IDENTIFIER) {
+      // The identifiers of the chunks are merged into parallel_identifiers.
+      const auto spelling = expected.data.identifier->get_spelling();
+      ASSERT_EQ(token.data.identifier->get_spelling(), spelling);
+      ASSERT_EQ(token.data.identifier, parallel_identifiers.get(spelling));
+    }
+  }
+}
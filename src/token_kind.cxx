@@ -2,6 +2,10 @@
 
 #include <hedley.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
 const char*
 token_kind_get_name(PTokenKind p_token_kind)
 {
@@ -34,3 +38,97 @@ token_kind_get_spelling(PTokenKind p_token_kind)
       return nullptr;
   }
 }
+
+struct PKeyword
+{
+  std::string_view spelling;
+  PTokenKind kind;
+};
+
+static constexpr PKeyword g_keywords[] = {
+#define TOKEN(p_kind)
+#define KEYWORD(p_spelling) { #p_spelling, P_TOK_KEY_##p_spelling },
+#include "token_kind.def"
+};
+
+static constexpr size_t g_keyword_count = sizeof(g_keywords) / sizeof(g_keywords[0]);
+static_assert(g_keyword_count < UINT8_MAX, "keyword indices must fit in a byte");
+
+static constexpr size_t g_keyword_min_length = [] {
+  size_t length = SIZE_MAX;
+  for (const auto& keyword : g_keywords)
+    length = std::min(length, keyword.spelling.size());
+  return length;
+}();
+
+static constexpr size_t g_keyword_max_length = [] {
+  size_t length = 0;
+  for (const auto& keyword : g_keywords)
+    length = std::max(length, keyword.spelling.size());
+  return length;
+}();
+
+// The table has a load factor of about 1/4 so that a seed without collisions
+// is quickly found at compile time.
+static constexpr unsigned g_keyword_table_bits = 7;
+static constexpr size_t g_keyword_table_size = 1 << g_keyword_table_bits;
+static_assert(g_keyword_count * 2 <= g_keyword_table_size, "keyword table is too small");
+
+// Marks an empty slot of the keyword table.
+static constexpr uint8_t g_no_keyword = UINT8_MAX;
+
+/// Hashes the length and the first, middle and last characters of
+/// p_spelling (which must not be empty). This is enough to tell apart all
+/// keywords, the full spelling is compared after the lookup anyway.
+static constexpr uint32_t
+keyword_hash(std::string_view p_spelling, uint32_t p_seed)
+{
+  uint32_t hash = static_cast<uint32_t>(p_spelling.size()) * p_seed;
+  hash = (hash ^ static_cast<unsigned char>(p_spelling.front())) * p_seed;
+  hash = (hash ^ static_cast<unsigned char>(p_spelling[p_spelling.size() / 2])) * p_seed;
+  hash = (hash ^ static_cast<unsigned char>(p_spelling.back())) * p_seed;
+  return hash >> (32 - g_keyword_table_bits);
+}
+
+/// Returns true if no two keywords have the same hash with p_seed.
+static constexpr bool
+is_perfect_keyword_seed(uint32_t p_seed)
+{
+  std::array<bool, g_keyword_table_size> used = {};
+  for (const auto& keyword : g_keywords) {
+    const uint32_t slot = keyword_hash(keyword.spelling, p_seed);
+    if (used[slot])
+      return false;
+    used[slot] = true;
+  }
+  return true;
+}
+
+static constexpr uint32_t g_keyword_seed = [] {
+  uint32_t seed = 0x9E3779B1; // odd, so that multiplications do not lose bits
+  while (!is_perfect_keyword_seed(seed))
+    seed += 2;
+  return seed;
+}();
+
+// Maps the hash of a keyword to its index in g_keywords.
+static constexpr auto g_keyword_table = [] {
+  std::array<uint8_t, g_keyword_table_size> table = {};
+  table.fill(g_no_keyword);
+  for (size_t i = 0; i < g_keyword_count; ++i)
+    table[keyword_hash(g_keywords[i].spelling, g_keyword_seed)] = static_cast<uint8_t>(i);
+  return table;
+}();
+
+PTokenKind
+token_kind_get_keyword(std::string_view p_spelling)
+{
+  if (p_spelling.size() < g_keyword_min_length || p_spelling.size() > g_keyword_max_length)
+    return P_TOK_IDENTIFIER;
+
+  const uint8_t index = g_keyword_table[keyword_hash(p_spelling, g_keyword_seed)];
+  if (index == g_no_keyword || g_keywords[index].spelling != p_spelling)
+    return P_TOK_IDENTIFIER;
+
+  return g_keywords[index].kind;
+}
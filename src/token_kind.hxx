@@ -1,6 +1,8 @@
 #ifndef PEONY_TOKEN_KIND_HXX
 #define PEONY_TOKEN_KIND_HXX
 
+#include <string_view>
+
 /// All the supported token kinds.
 enum PTokenKind
 {
@@ -18,4 +20,12 @@ token_kind_get_name(PTokenKind p_token_kind);
 const char*
 token_kind_get_spelling(PTokenKind p_token_kind);
 
+/// Returns the keyword token kind spelled p_spelling (e.g. P_TOK_KEY_fn for
+/// `fn`) or P_TOK_IDENTIFIER if p_spelling is not a keyword.
+///
+/// Keywords are recognized with a perfect hash table built at compile time
+/// from token_kind.def, so that they never enter the identifier table.
+PTokenKind
+token_kind_get_keyword(std::string_view p_spelling);
+
 #endif // PEONY_TOKEN_KIND_HXX
@@ -0,0 +1,18 @@
+#include "token_kind.hxx"
+
+#include <gtest/gtest.h>
+
+TEST(token_kind, get_keyword)
+{
+#define TOKEN(p_kind)
+#define KEYWORD(p_spelling) EXPECT_EQ(token_kind_get_keyword(#p_spelling), P_TOK_KEY_##p_spelling);
+#include "token_kind.def"
+
+  EXPECT_EQ(token_kind_get_keyword("a"), P_TOK_IDENTIFIER);
+  EXPECT_EQ(token_kind_get_keyword("foo"), P_TOK_IDENTIFIER);
+  EXPECT_EQ(token_kind_get_keyword("i128"), P_TOK_IDENTIFIER);
+  EXPECT_EQ(token_kind_get_keyword("fo"), P_TOK_IDENTIFIER);
+  EXPECT_EQ(token_kind_get_keyword("If"), P_TOK_IDENTIFIER);
+  EXPECT_EQ(token_kind_get_keyword("continues"), P_TOK_IDENTIFIER);
+  EXPECT_EQ(token_kind_get_keyword("a_very_long_identifier"), P_TOK_IDENTIFIER);
+}
@@ -5,7 +5,7 @@
 
 TEST(Type, paren_type)
 {
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   PType* f32_ty = ctx.get_f32_ty();
   ASSERT_NE(f32_ty, nullptr);
@@ -29,7 +29,7 @@ TEST(Type, paren_type)
 
 TEST(Type, function_type)
 {
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   PType* ret_ty = ctx.get_paren_ty(ctx.get_f32_ty());
   PType* args_ty[] = { ctx.get_i32_ty(), ctx.get_paren_ty(ctx.get_bool_ty()) };
@@ -65,7 +65,7 @@ TEST(Type, function_type)
 
 TEST(Type, pointer_type)
 {
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   PType* f32_ty = ctx.get_f32_ty();
   ASSERT_NE(f32_ty, nullptr);
@@ -93,7 +93,7 @@ TEST(Type, pointer_type)
 
 TEST(Type, array_type)
 {
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   PType* f32_ty = ctx.get_f32_ty();
   ASSERT_NE(f32_ty, nullptr);
@@ -125,7 +125,7 @@ TEST(Type, array_type)
 
 TEST(Type, is_predicates)
 {
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   // i: is_int_ty()
   // s: is_signed_int_ty()
@@ -173,7 +173,7 @@ TEST(Type, is_predicates_non_canonical_type)
   // Type::is_*() predicates must test canonical id.
   // That is `((int))`.is_int_ty() must returns true (note the parenthesizes).
 
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   auto* ty0 = ctx.get_paren_ty(ctx.get_i32_ty());
   EXPECT_TRUE(ty0->is_int_ty());
@@ -201,7 +201,7 @@ TEST(Type, is_predicates_non_canonical_type)
 
 TEST(Type, to_signed_unsigned_int_ty)
 {
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   // to_signed_int_ty()
   EXPECT_EQ(ctx.get_i8_ty()->to_signed_int_ty(ctx), ctx.get_i8_ty());
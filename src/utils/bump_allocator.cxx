@@ -0,0 +1,127 @@
+#include "bump_allocator.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+
+/// The size of a huge page on x86-64 and AArch64 (with 4 KiB base pages).
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+#endif
+
+/// The header at the beginning of each slab, followed by the allocations.
+struct PBumpAllocator::PSlab
+{
+  PSlab* previous;
+  size_t size; // including the header
+  bool is_mapped; // allocated by mmap() rather than malloc()
+};
+
+PBumpAllocator::PBumpAllocator(const PBumpAllocatorOptions& p_options)
+  : m_options(p_options)
+  , m_next_slab_size(p_options.initial_slab_size)
+{
+  assert(p_options.growth_factor >= 1.0f);
+}
+
+PBumpAllocator::~PBumpAllocator() noexcept
+{
+  free_slabs(m_current_slab, nullptr);
+  free_slabs(m_last_custom_slab, nullptr);
+}
+
+void
+PBumpAllocator::rewind(const PCheckpoint& p_checkpoint)
+{
+  free_slabs(m_current_slab, p_checkpoint.slab);
+  free_slabs(m_last_custom_slab, p_checkpoint.custom_slab);
+
+  m_ptr = p_checkpoint.ptr;
+  m_end = (m_current_slab != nullptr) ? reinterpret_cast<char*>(m_current_slab) + m_current_slab->size : nullptr;
+  m_allocated_bytes = p_checkpoint.allocated_bytes;
+}
+
+void*
+PBumpAllocator::alloc_slow(size_t p_size, size_t p_alignment)
+{
+  const size_t min_size = sizeof(PSlab) + p_alignment - 1 + p_size;
+
+  // Large allocations get a slab of their own. The allocations then continue
+  // in the current slab, whose free space would be lost otherwise.
+  if (min_size > m_next_slab_size) {
+    m_last_custom_slab = new_slab(min_size, m_last_custom_slab);
+    m_allocated_bytes += p_size;
+
+    const uintptr_t ptr = reinterpret_cast<uintptr_t>(m_last_custom_slab + 1);
+    return reinterpret_cast<void*>((ptr + p_alignment - 1) & ~(p_alignment - 1));
+  }
+
+  // The rest of the current slab is lost, this is negligible as the slabs
+  // are much larger than most allocations.
+  m_current_slab = new_slab(m_next_slab_size, m_current_slab);
+  m_ptr = reinterpret_cast<char*>(m_current_slab + 1);
+  m_end = reinterpret_cast<char*>(m_current_slab) + m_current_slab->size;
+
+  const auto next_size = static_cast<size_t>(static_cast<float>(m_next_slab_size) * m_options.growth_factor);
+  m_next_slab_size = std::min(next_size, std::max(m_options.max_slab_size, m_next_slab_size));
+
+  void* ptr = alloc(p_size, p_alignment);
+  assert(ptr != nullptr || p_size == 0);
+  return ptr;
+}
+
+PBumpAllocator::PSlab*
+PBumpAllocator::new_slab(size_t p_size, PSlab* p_previous)
+{
+  size_t size = p_size;
+  void* memory = nullptr;
+  bool is_mapped = false;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (m_options.use_huge_pages && size >= HUGE_PAGE_SIZE) {
+    size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+      memory = nullptr;
+    } else {
+      // Only a hint, the kernel may not have huge pages available.
+      madvise(memory, size, MADV_HUGEPAGE);
+      is_mapped = true;
+    }
+  }
+#endif
+  if (memory == nullptr)
+    memory = malloc(size);
+  if (memory == nullptr)
+    throw std::bad_alloc();
+
+  m_reserved_bytes += size;
+  ++m_slab_count;
+  return new (memory) PSlab{ p_previous, size, is_mapped };
+}
+
+void
+PBumpAllocator::free_slab(PSlab* p_slab)
+{
+  m_reserved_bytes -= p_slab->size;
+  --m_slab_count;
+
+#if defined(__linux__)
+  if (p_slab->is_mapped) {
+    munmap(p_slab, p_slab->size);
+    return;
+  }
+#endif
+  free(p_slab);
+}
+
+void
+PBumpAllocator::free_slabs(PSlab*& p_list, PSlab* p_last)
+{
+  while (p_list != p_last) {
+    assert(p_list != nullptr && "checkpoint of another allocator or invalidated");
+    PSlab* previous = p_list->previous;
+    free_slab(p_list);
+    p_list = previous;
+  }
+}
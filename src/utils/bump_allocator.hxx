@@ -1,6 +1,28 @@
 #pragma once
 
-#include <memory_resource>
+#include <hedley.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+/// The settings of a PBumpAllocator.
+struct PBumpAllocatorOptions
+{
+  /// The size in bytes of the first slab.
+  size_t initial_slab_size = 4096;
+  /// Each new slab is growth_factor times larger than the previous one, up to
+  /// max_slab_size bytes. Larger allocations get a slab of their own size,
+  /// which does not replace the current slab.
+  float growth_factor = 2.0f;
+  size_t max_slab_size = 4 << 20;
+  /// Backs the slabs of at least 2 MiB by transparent huge pages, which
+  /// reduces the TLB misses of big compilations. Only supported on Linux,
+  /// ignored elsewhere.
+  bool use_huge_pages = false;
+};
 
 /// This class implements a bump allocator.
 ///
@@ -16,15 +38,46 @@
 /// These trade offs make bump allocation well-suited for phase-oriented allocations. That is, a group of objects that
 /// will all be allocated during the same program phase, used, and then can all be deallocated together as a group.
 /// </quote>
+///
+/// The chunks (called slabs here) grow geometrically, see PBumpAllocatorOptions.
+/// The last allocations can however be discarded as a group by rewinding the
+/// allocator to a previous checkpoint (e.g. after an abandoned speculative
+/// parse).
 class PBumpAllocator
 {
+  struct PSlab;
+
 public:
+  /// The state of the allocator at some point, see checkpoint().
+  struct PCheckpoint
+  {
+    PSlab* slab;
+    PSlab* custom_slab;
+    char* ptr;
+    size_t allocated_bytes;
+  };
+
   PBumpAllocator() = default;
-  ~PBumpAllocator() noexcept = default;
+  explicit PBumpAllocator(const PBumpAllocatorOptions& p_options);
+  ~PBumpAllocator() noexcept;
+
+  PBumpAllocator(const PBumpAllocator&) = delete;
+  PBumpAllocator& operator=(const PBumpAllocator&) = delete;
 
+  /// Allocates p_size bytes aligned to p_alignment (a power of two). The
+  /// result may be nullptr when p_size is zero.
   [[nodiscard]] void* alloc(size_t p_size, size_t p_alignment)
   {
-    return m_buffer.allocate(p_size, p_alignment);
+    assert(p_alignment != 0 && (p_alignment & (p_alignment - 1)) == 0);
+
+    const uintptr_t ptr = reinterpret_cast<uintptr_t>(m_ptr);
+    const uintptr_t aligned_ptr = (ptr + p_alignment - 1) & ~(p_alignment - 1);
+    if (HEDLEY_UNLIKELY(aligned_ptr - ptr + p_size > static_cast<size_t>(m_end - m_ptr)))
+      return alloc_slow(p_size, p_alignment);
+
+    m_ptr = reinterpret_cast<char*>(aligned_ptr) + p_size;
+    m_allocated_bytes += p_size;
+    return reinterpret_cast<void*>(aligned_ptr);
   }
   template<typename T>
   [[nodiscard]] T* alloc_with_extra_size(size_t p_extra_size)
@@ -45,6 +98,45 @@ public:
     return ptr;
   }
 
+  /// Returns the current state of the allocator, to later discard all the
+  /// allocations done after this call with rewind().
+  [[nodiscard]] PCheckpoint checkpoint() const
+  {
+    return { m_current_slab, m_last_custom_slab, m_ptr, m_allocated_bytes };
+  }
+  /// Discards all the allocations done since p_checkpoint was taken. The
+  /// slabs allocated since then are freed. The objects are not destroyed.
+  ///
+  /// The checkpoints taken after p_checkpoint are invalidated.
+  void rewind(const PCheckpoint& p_checkpoint);
+
+  /// Returns the count of bytes requested by all the allocations (without the
+  /// alignment padding).
+  [[nodiscard]] size_t get_allocated_bytes() const { return m_allocated_bytes; }
+  /// Returns the count of bytes of all the slabs.
+  [[nodiscard]] size_t get_reserved_bytes() const { return m_reserved_bytes; }
+  [[nodiscard]] size_t get_slab_count() const { return m_slab_count; }
+
 private:
-  std::pmr::monotonic_buffer_resource m_buffer;
+  /// Allocates a new slab large enough for the allocation, then allocates in it.
+  [[nodiscard]] void* alloc_slow(size_t p_size, size_t p_alignment);
+  [[nodiscard]] PSlab* new_slab(size_t p_size, PSlab* p_previous);
+  void free_slab(PSlab* p_slab);
+  /// Frees the slabs of the given list until p_last (excluded).
+  void free_slabs(PSlab*& p_list, PSlab* p_last);
+
+  PBumpAllocatorOptions m_options;
+  // The allocations are done in [m_ptr, m_end) of the current slab.
+  char* m_ptr = nullptr;
+  char* m_end = nullptr;
+  // The slabs form a linked list, from the current one to the first one.
+  PSlab* m_current_slab = nullptr;
+  // The slabs sized for a single large allocation are kept in their own list,
+  // so that the allocations continue in the current slab after them.
+  PSlab* m_last_custom_slab = nullptr;
+  size_t m_next_slab_size = m_options.initial_slab_size;
+
+  size_t m_allocated_bytes = 0;
+  size_t m_reserved_bytes = 0;
+  size_t m_slab_count = 0;
 };
@@ -0,0 +1,149 @@
+#include "bump_allocator.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+TEST(bump_allocator, alignment)
+{
+  PBumpAllocator allocator;
+  for (size_t alignment = 1; alignment <= 256; alignment *= 2) {
+    (void)allocator.alloc(1, 1);
+    void* ptr = allocator.alloc(3, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+  }
+}
+
+TEST(bump_allocator, statistics)
+{
+  PBumpAllocator allocator;
+  EXPECT_EQ(allocator.get_allocated_bytes(), 0);
+  EXPECT_EQ(allocator.get_reserved_bytes(), 0);
+  EXPECT_EQ(allocator.get_slab_count(), 0);
+
+  auto* a = allocator.alloc_object<int>(10);
+  auto* b = allocator.alloc_object<int>(10);
+  EXPECT_EQ(allocator.get_allocated_bytes(), 20 * sizeof(int));
+  EXPECT_EQ(allocator.get_slab_count(), 1);
+  EXPECT_GE(allocator.get_reserved_bytes(), allocator.get_allocated_bytes());
+
+  // The allocations do not overlap.
+  memset(a, 0x11, 10 * sizeof(int));
+  memset(b, 0x22, 10 * sizeof(int));
+  EXPECT_EQ(a[9], 0x11111111);
+}
+
+TEST(bump_allocator, slab_growth)
+{
+  PBumpAllocatorOptions options;
+  options.initial_slab_size = 1024;
+  options.growth_factor = 2.0f;
+  options.max_slab_size = 4096;
+  PBumpAllocator allocator(options);
+
+  // Slabs of 1, 2, 4, 4, ... KiB.
+  for (int i = 0; i < 5000; ++i)
+    (void)allocator.alloc(8, 8);
+  EXPECT_EQ(allocator.get_allocated_bytes(), 5000 * 8);
+  EXPECT_EQ(allocator.get_reserved_bytes(), 1024 + 2048 + (allocator.get_slab_count() - 2) * 4096);
+  EXPECT_LE(allocator.get_reserved_bytes(), allocator.get_allocated_bytes() + 4096);
+
+  // Larger allocations get their own slab.
+  void* large = allocator.alloc(100000, 16);
+  EXPECT_NE(large, nullptr);
+  memset(large, 0, 100000);
+  EXPECT_GE(allocator.get_reserved_bytes(), 5000 * 8 + 100000);
+}
+
+TEST(bump_allocator, large_allocation)
+{
+  PBumpAllocatorOptions options;
+  options.initial_slab_size = 1024;
+  PBumpAllocator allocator(options);
+
+  auto* a = allocator.new_object<int>(42);
+  void* large = allocator.alloc(100000, 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 64, 0);
+  memset(large, 0, 100000);
+  EXPECT_EQ(allocator.get_slab_count(), 2);
+
+  // The allocations continue in the current slab, not in the large one.
+  auto* b = allocator.new_object<int>(43);
+  EXPECT_EQ(b, a + 1);
+  EXPECT_EQ(allocator.get_slab_count(), 2);
+  EXPECT_EQ(allocator.get_allocated_bytes(), 100000 + 2 * sizeof(int));
+}
+
+TEST(bump_allocator, rewind_large_allocation)
+{
+  PBumpAllocatorOptions options;
+  options.initial_slab_size = 1024;
+  PBumpAllocator allocator(options);
+
+  (void)allocator.alloc(100000, 8);
+  const auto checkpoint = allocator.checkpoint();
+  const size_t reserved_bytes = allocator.get_reserved_bytes();
+
+  (void)allocator.new_object<int>(42);
+  (void)allocator.alloc(200000, 8);
+  EXPECT_EQ(allocator.get_slab_count(), 3);
+
+  // Both the regular and the large slabs allocated since the checkpoint are freed.
+  allocator.rewind(checkpoint);
+  EXPECT_EQ(allocator.get_slab_count(), 1);
+  EXPECT_EQ(allocator.get_reserved_bytes(), reserved_bytes);
+  EXPECT_EQ(allocator.get_allocated_bytes(), 100000);
+  EXPECT_NE(allocator.new_object<int>(43), nullptr);
+}
+
+TEST(bump_allocator, rewind)
+{
+  PBumpAllocatorOptions options;
+  options.initial_slab_size = 256;
+  PBumpAllocator allocator(options);
+
+  auto* a = allocator.new_object<int>(42);
+  const auto checkpoint = allocator.checkpoint();
+  const size_t reserved_bytes = allocator.get_reserved_bytes();
+
+  // Enough to allocate new slabs, which are freed by rewind().
+  for (int i = 0; i < 100; ++i)
+    (void)allocator.alloc(64, 8);
+  EXPECT_GT(allocator.get_slab_count(), 1);
+
+  allocator.rewind(checkpoint);
+  EXPECT_EQ(allocator.get_allocated_bytes(), sizeof(int));
+  EXPECT_EQ(allocator.get_reserved_bytes(), reserved_bytes);
+  EXPECT_EQ(allocator.get_slab_count(), 1);
+  EXPECT_EQ(*a, 42);
+
+  // The memory after the checkpoint is reused.
+  auto* b = allocator.new_object<int>(43);
+  EXPECT_EQ(b, a + 1);
+  EXPECT_EQ(*a, 42);
+}
+
+TEST(bump_allocator, rewind_to_empty)
+{
+  PBumpAllocator allocator;
+  const auto checkpoint = allocator.checkpoint();
+  (void)allocator.alloc(10000, 8);
+  allocator.rewind(checkpoint);
+  EXPECT_EQ(allocator.get_slab_count(), 0);
+  EXPECT_EQ(allocator.get_reserved_bytes(), 0);
+  EXPECT_NE(allocator.alloc(8, 8), nullptr);
+}
+
+TEST(bump_allocator, huge_pages)
+{
+  // Huge pages are only a hint, the allocations must work without them.
+  PBumpAllocatorOptions options;
+  options.initial_slab_size = 4 << 20;
+  options.use_huge_pages = true;
+  PBumpAllocator allocator(options);
+
+  auto* data = allocator.alloc_object<char>(5 << 20);
+  memset(data, 1, 5 << 20);
+  EXPECT_GE(allocator.get_reserved_bytes(), 5 << 20);
+  EXPECT_EQ(allocator.get_slab_count(), 1);
+}
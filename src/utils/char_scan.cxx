@@ -0,0 +1,154 @@
+#include "char_scan.hxx"
+
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define P_CHAR_SCAN_BLOCK_SIZE 32
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define P_CHAR_SCAN_BLOCK_SIZE 16
+#endif
+
+static inline bool
+is_whitespace(char p_c)
+{
+  return p_c == ' ' || (unsigned char)(p_c - '\t') <= ('\r' - '\t');
+}
+
+static inline bool
+is_line_end(char p_c)
+{
+  return p_c == '\n' || p_c == '\r' || p_c == '\0';
+}
+
+#ifdef P_CHAR_SCAN_BLOCK_SIZE
+// A block of P_CHAR_SCAN_BLOCK_SIZE characters. Comparisons return a bit mask
+// with the bit i set if the comparison is true for the i-th character.
+struct PCharBlock
+{
+#if defined(__AVX2__)
+  __m256i v;
+
+  static PCharBlock load(const char* p_ptr) { return { _mm256_loadu_si256((const __m256i*)p_ptr) }; }
+  [[nodiscard]] uint32_t eq(char p_c) const
+  {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(p_c)));
+  }
+  /// Compares (as unsigned) v - p_first <= p_last - p_first.
+  [[nodiscard]] uint32_t in_range(char p_first, char p_last) const
+  {
+    const __m256i offset = _mm256_sub_epi8(v, _mm256_set1_epi8(p_first));
+    const __m256i bound = _mm256_set1_epi8((char)(p_last - p_first));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(offset, bound), offset));
+  }
+#else
+  __m128i v;
+
+  static PCharBlock load(const char* p_ptr) { return { _mm_loadu_si128((const __m128i*)p_ptr) }; }
+  [[nodiscard]] uint32_t eq(char p_c) const
+  {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(p_c)));
+  }
+  /// Compares (as unsigned) v - p_first <= p_last - p_first.
+  [[nodiscard]] uint32_t in_range(char p_first, char p_last) const
+  {
+    const __m128i offset = _mm_sub_epi8(v, _mm_set1_epi8(p_first));
+    const __m128i bound = _mm_set1_epi8((char)(p_last - p_first));
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(offset, bound), offset));
+  }
+#endif
+};
+
+// All bits of a block mask set.
+static constexpr uint32_t g_full_mask = (uint32_t)((1ull << P_CHAR_SCAN_BLOCK_SIZE) - 1);
+#endif
+
+const char*
+p_skip_whitespace(const char* p_begin, const char* p_end)
+{
+  const char* it = p_begin;
+
+  // Most whitespace runs are a single space, do not bother with vectors.
+  if (it == p_end || !is_whitespace(*it))
+    return it;
+
+#ifdef P_CHAR_SCAN_BLOCK_SIZE
+  while (p_end - it >= P_CHAR_SCAN_BLOCK_SIZE) {
+    const auto block = PCharBlock::load(it);
+    const uint32_t mask = block.eq(' ') | block.in_range('\t', '\r');
+    if (mask != g_full_mask)
+      return it + std::countr_one(mask);
+    it += P_CHAR_SCAN_BLOCK_SIZE;
+  }
+#endif
+
+  while (it != p_end && is_whitespace(*it))
+    ++it;
+  return it;
+}
+
+const char*
+p_find_line_end(const char* p_begin, const char* p_end)
+{
+  const char* it = p_begin;
+
+#ifdef P_CHAR_SCAN_BLOCK_SIZE
+  while (p_end - it >= P_CHAR_SCAN_BLOCK_SIZE) {
+    const auto block = PCharBlock::load(it);
+    const uint32_t mask = block.eq('\n') | block.eq('\r') | block.eq('\0');
+    if (mask != 0)
+      return it + std::countr_zero(mask);
+    it += P_CHAR_SCAN_BLOCK_SIZE;
+  }
+#endif
+
+  while (it != p_end && !is_line_end(*it))
+    ++it;
+  return it;
+}
+
+const char*
+p_find_any_of(const char* p_begin, const char* p_end, std::string_view p_chars)
+{
+  const char* it = p_begin;
+
+#ifdef P_CHAR_SCAN_BLOCK_SIZE
+  while (p_end - it >= P_CHAR_SCAN_BLOCK_SIZE) {
+    const auto block = PCharBlock::load(it);
+    uint32_t mask = 0;
+    for (char c : p_chars)
+      mask |= block.eq(c);
+    if (mask != 0)
+      return it + std::countr_zero(mask);
+    it += P_CHAR_SCAN_BLOCK_SIZE;
+  }
+#endif
+
+  while (it != p_end && p_chars.find(*it) == std::string_view::npos)
+    ++it;
+  return it;
+}
+
+void
+p_find_line_starts(const char* p_begin, const char* p_end, std::vector<uint32_t>& p_positions)
+{
+  const char* it = p_begin;
+
+#ifdef P_CHAR_SCAN_BLOCK_SIZE
+  while (p_end - it >= P_CHAR_SCAN_BLOCK_SIZE) {
+    uint32_t mask = PCharBlock::load(it).eq('\n');
+    const auto offset = static_cast<uint32_t>(it - p_begin) + 1;
+    while (mask != 0) {
+      p_positions.push_back(offset + std::countr_zero(mask));
+      mask &= mask - 1; // clear the lowest set bit
+    }
+    it += P_CHAR_SCAN_BLOCK_SIZE;
+  }
+#endif
+
+  for (; it != p_end; ++it) {
+    if (*it == '\n')
+      p_positions.push_back(static_cast<uint32_t>(it - p_begin) + 1);
+  }
+}
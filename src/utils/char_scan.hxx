@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/// Vectorized scanning of source buffers, used by the lexer and the line map.
+///
+/// The functions process 32 bytes at a time with AVX2 (when the compiler
+/// targets it, e.g. with -mavx2), 16 bytes at a time with SSE2 and otherwise
+/// fall back to a scalar loop. They never read past p_end.
+
+/// Returns a pointer to the first character of [p_begin, p_end) that is not a
+/// whitespace (one of ` \t\v\f\r\n`), or p_end if there is none.
+[[nodiscard]] const char*
+p_skip_whitespace(const char* p_begin, const char* p_end);
+
+/// Returns a pointer to the first `\n`, `\r` or NUL character of
+/// [p_begin, p_end), or p_end if there is none.
+[[nodiscard]] const char*
+p_find_line_end(const char* p_begin, const char* p_end);
+
+/// Returns a pointer to the first character of [p_begin, p_end) that is one
+/// of p_chars, or p_end if there is none.
+[[nodiscard]] const char*
+p_find_any_of(const char* p_begin, const char* p_end, std::string_view p_chars);
+
+/// Appends to p_positions the offset (relative to p_begin) of the character
+/// following each `\n` of [p_begin, p_end), in increasing order.
+void
+p_find_line_starts(const char* p_begin, const char* p_end, std::vector<uint32_t>& p_positions);
@@ -0,0 +1,71 @@
+#include "char_scan.hxx"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+// The inputs are long enough to be processed by several vector blocks plus a
+// scalar tail.
+
+TEST(char_scan, skip_whitespace)
+{
+  EXPECT_EQ(*p_skip_whitespace("a  ", "a  " + 3), 'a');
+
+  for (size_t length = 0; length < 100; ++length) {
+    const std::string input = std::string(length, ' ') + "\t\v\f\r\n" + "x" + std::string(40, ' ');
+    const char* end = input.data() + input.size();
+    EXPECT_EQ(p_skip_whitespace(input.data(), end), input.data() + length + 5);
+  }
+
+  const std::string spaces(70, '\n');
+  EXPECT_EQ(p_skip_whitespace(spaces.data(), spaces.data() + spaces.size()), spaces.data() + spaces.size());
+  // Does not stop at other control characters.
+  const std::string controls = std::string(33, ' ') + "\x08" + "\x0e";
+  EXPECT_EQ(p_skip_whitespace(controls.data(), controls.data() + controls.size()), controls.data() + 33);
+}
+
+TEST(char_scan, find_line_end)
+{
+  for (size_t length = 0; length < 100; ++length) {
+    for (char terminator : { '\n', '\r', '\0' }) {
+      std::string input = std::string(length, 'a') + terminator + std::string(40, 'b');
+      const char* end = input.data() + input.size();
+      EXPECT_EQ(p_find_line_end(input.data(), end), input.data() + length);
+    }
+  }
+
+  const std::string no_line_end(70, 'a');
+  EXPECT_EQ(p_find_line_end(no_line_end.data(), no_line_end.data() + no_line_end.size()),
+            no_line_end.data() + no_line_end.size());
+}
+
+TEST(char_scan, find_line_starts)
+{
+  std::string input;
+  std::vector<uint32_t> expected;
+  for (size_t i = 0; i < 50; ++i) {
+    input += std::string(i % 7, 'a');
+    input += (i % 3 == 0) ? "\r\n" : "\n";
+    expected.push_back(static_cast<uint32_t>(input.size()));
+  }
+
+  std::vector<uint32_t> positions;
+  p_find_line_starts(input.data(), input.data() + input.size(), positions);
+  EXPECT_EQ(positions, expected);
+}
+
+TEST(char_scan, find_any_of)
+{
+  using namespace std::string_view_literals;
+
+  for (size_t length = 0; length < 100; ++length) {
+    for (char c : { '/', '"', '\0' }) {
+      std::string input = std::string(length, 'a') + c + std::string(40, '/');
+      const char* end = input.data() + input.size();
+      EXPECT_EQ(p_find_any_of(input.data(), end, "/\"\0"sv), input.data() + length);
+    }
+  }
+
+  const std::string none(70, 'a');
+  EXPECT_EQ(p_find_any_of(none.data(), none.data() + none.size(), "bc"), none.data() + none.size());
+}
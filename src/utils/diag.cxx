@@ -5,27 +5,33 @@
 
 #include <hedley.h>
 
+#include <atomic>
 #include <cassert>
 #include <cctype>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 
-PDiagContext g_diag_context = { .diagnostic_count = { 0 },
-                                .max_errors = 0,
-                                .warning_as_errors = false,
-                                .fatal_errors = false,
-                                .ignore_notes = false,
-                                .ignore_warnings = false };
+thread_local PDiagContext g_diag_context = { .diagnostic_count = { 0 },
+                                             .max_errors = 0,
+                                             .warning_as_errors = false,
+                                             .fatal_errors = false,
+                                             .ignore_notes = false,
+                                             .ignore_warnings = false,
+                                             .output = nullptr };
 
 #ifdef P_DEBUG
-static PDiag g_current_diag = { .debug_was_flushed = true };
+static thread_local PDiag g_current_diag = { .debug_was_flushed = true };
 #else
-static PDiag g_current_diag;
+static thread_local PDiag g_current_diag;
 #endif
 
-PSourceLocation g_current_source_location = 0;
-PSourceFile* g_current_source_file = nullptr;
+// The errors reported by all the threads, for -fmax-errors.
+static std::atomic<int> g_error_count = 0;
+static std::atomic<bool> g_compilation_stopped = false;
+
+thread_local PSourceLocation g_current_source_location = 0;
+thread_local PSourceFile* g_current_source_file = nullptr;
 
 static const char* g_diag_severity_names[] = {
   "unspecified", "note", "warning", "error", "fatal error",
@@ -185,6 +191,10 @@ diag_add_source_caret(PDiag* p_diag, PSourceLocation p_loc)
 void
 diag_flush(PDiag* p_diag)
 {
+#ifdef P_DEBUG
+  p_diag->debug_was_flushed = true;
+#endif
+
   if (g_diag_context.ignore_notes && p_diag->severity == P_DIAG_NOTE)
     return;
   if (g_diag_context.ignore_warnings && p_diag->severity == P_DIAG_WARNING)
@@ -196,9 +206,28 @@ diag_flush(PDiag* p_diag)
 
   g_diag_context.diagnostic_count[p_diag->severity]++;
 
-#ifdef P_DEBUG
-  p_diag->debug_was_flushed = true;
-#endif
+  // The diagnostics reported after the stop are dropped, but still counted
+  // above so that the job fails.
+  if (diag_is_compilation_stopped())
+    return;
+
+  const int max_errors = g_options.opt_diagnostics_max_errors;
+  bool max_errors_reached = false;
+  if (p_diag->severity == P_DIAG_ERROR) {
+    const int error_count = g_error_count.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (max_errors != 0 && error_count > max_errors)
+      return; // the limit was reached concurrently by another thread
+    max_errors_reached = (max_errors != 0 && error_count == max_errors);
+  }
+
+  const bool fatal_errors = g_diag_context.fatal_errors || g_options.opt_w_fatal_erros;
+  if (fatal_errors && p_diag->severity == P_DIAG_ERROR && !max_errors_reached) {
+    // Only the first fatal error is reported, if several threads get one.
+    if (g_compilation_stopped.exchange(true))
+      return;
+  }
+
+  FILE* output = diag_get_output();
 
   // Print source location:
   if (g_current_source_file != nullptr) {
@@ -209,36 +238,64 @@ diag_flush(PDiag* p_diag)
     colno += g_options.opt_diagnostics_column_origin;
 
     if (g_options.opt_diagnostics_show_column) {
-      fprintf(stderr, "%s:%d:%d: ", g_current_source_file->get_filename().c_str(), lineno, colno);
+      fprintf(output, "%s:%d:%d: ", g_current_source_file->get_filename().c_str(), lineno, colno);
     } else {
-      fprintf(stderr, "%s:%d: ", g_current_source_file->get_filename().c_str(), lineno);
+      fprintf(output, "%s:%d: ", g_current_source_file->get_filename().c_str(), lineno);
     }
   }
 
   // Print severity:
   if (g_options.opt_diagnostics_color)
-    fputs(g_diag_severity_colors[p_diag->severity], stderr);
-  fputs(g_diag_severity_names[p_diag->severity], stderr);
-  fputs(": ", stderr);
+    fputs(g_diag_severity_colors[p_diag->severity], output);
+  fputs(g_diag_severity_names[p_diag->severity], output);
+  fputs(": ", output);
   if (g_options.opt_diagnostics_color)
-    fputs("\x1b[0m", stderr);
+    fputs("\x1b[0m", output);
 
   std::string buffer;
   p_diag_format_msg(buffer, p_diag->message, p_diag->args, p_diag->arg_count);
 
-  fputs(buffer.c_str(), stderr);
-  fputs("\n", stderr);
+  fputs(buffer.c_str(), output);
+  fputs("\n", output);
   if (p_diag->range_count > 0)
     p_diag_print_source_ranges(g_current_source_file, p_diag->ranges, p_diag->range_count);
 
-  if (g_options.opt_diagnostics_max_errors != 0 &&
-      g_diag_context.diagnostic_count[P_DIAG_ERROR] >= g_options.opt_diagnostics_max_errors) {
-    fprintf(stderr, "compilation terminated due to -fmax-errors=%d.\n", g_options.opt_diagnostics_max_errors);
-    exit(EXIT_FAILURE);
+  // The driver stops the compilation, it can not exit() here as other
+  // threads may still be running.
+  if (max_errors_reached) {
+    fprintf(output, "compilation terminated due to -fmax-errors=%d.\n", max_errors);
+    g_compilation_stopped.store(true);
+  } else if (fatal_errors && p_diag->severity == P_DIAG_ERROR) {
+    fprintf(output, "compilation terminated due to -Wfatal-errors.\n");
   }
+}
 
-  if (g_diag_context.fatal_errors && p_diag->severity == P_DIAG_ERROR) {
-    fprintf(stderr, "compilation terminated due to -Wfatal-errors.\n");
-    exit(EXIT_FAILURE);
-  }
+bool
+diag_is_compilation_stopped()
+{
+  return g_compilation_stopped.load(std::memory_order_relaxed);
+}
+
+void
+diag_reset_error_limit()
+{
+  g_error_count.store(0);
+  g_compilation_stopped.store(false);
+}
+
+void
+diag_print_buffered_output(FILE* p_stream, FILE* p_output)
+{
+  if (p_stream == nullptr || p_stream == p_output)
+    return;
+
+  fflush(p_stream);
+  rewind(p_stream);
+
+  char buffer[4096];
+  size_t read_bytes;
+  while ((read_bytes = fread(buffer, sizeof(char), sizeof(buffer), p_stream)) > 0)
+    fwrite(buffer, sizeof(char), read_bytes, p_output);
+
+  fflush(p_output);
 }
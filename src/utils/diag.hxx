@@ -4,6 +4,7 @@
 #include "source_location.hxx"
 
 #include <cstdint>
+#include <cstdio>
 
 class PType;
 class PIdentifierInfo;
@@ -89,11 +90,39 @@ struct PDiagContext
   bool fatal_errors;
   bool ignore_notes;
   bool ignore_warnings;
+  // The stream where diagnostics are printed. If nullptr, stderr is used.
+  FILE* output;
 };
 
-extern PDiagContext g_diag_context;
+// The diagnostic state is per-thread so that several translation units can be
+// compiled concurrently, each one reporting its own diagnostics.
+extern thread_local PDiagContext g_diag_context;
 
-extern PSourceFile* g_current_source_file;
+extern thread_local PSourceFile* g_current_source_file;
+
+/// Returns the stream where diagnostics of the current thread are printed.
+inline FILE*
+diag_get_output()
+{
+  return (g_diag_context.output != nullptr) ? g_diag_context.output : stderr;
+}
+
+/// Returns true once the compilation must stop because of -fmax-errors or
+/// -Wfatal-errors. The threads compiling other files then finish their current
+/// file without reporting anything more, and do not start new ones; the
+/// driver exits once they are joined. Thread-safe.
+bool
+diag_is_compilation_stopped();
+
+/// Resets the count of errors of all the threads (see -fmax-errors) and
+/// clears the stop of the compilation.
+void
+diag_reset_error_limit();
+
+/// Copies everything that was written to p_stream (which must be seekable, e.g.
+/// created by tmpfile()) to p_output. Used to print buffered diagnostics.
+void
+diag_print_buffered_output(FILE* p_stream, FILE* p_output = stderr);
 
 #ifdef P_DEBUG
 PDiag*
@@ -190,7 +190,7 @@ print_char_n_times(char p_c, int p_n)
 {
   // FIXME: probably find a better way
   while (p_n--)
-    fputc(p_c, stderr);
+    fputc(p_c, diag_get_output());
 }
 
 static void
@@ -200,12 +200,12 @@ print_partial_src_range(struct PartialSourceRange* p_range, uint32_t p_current_c
     print_char_n_times(' ', p_range->colno_begin - p_current_colno);
 
   if (p_range->colno_begin == p_range->colno_end)
-    fputs("^", stderr);
+    fputs("^", diag_get_output());
   else
     print_char_n_times('~', p_range->colno_end - p_range->colno_begin);
 }
 
-/* Print a line margin to stderr of the form:
+/* Print a line margin to the diagnostic output of the form:
  * "    5 | "
  * If p_lineno is set to 0, no line number will be printed.
  * This function follows the formatting options given by user (cmd line options). */
@@ -223,9 +223,9 @@ print_line_margin(uint32_t p_lineno)
   } else {
     // FIXME: (char)('0' + (margin_width - 1)) is dangerous, for example if margin_width > 9
     char format[] = { '%', (char)('0' + (margin_width - 1)), 'd', '\0' };
-    fprintf(stderr, format, p_lineno);
+    fprintf(diag_get_output(), format, p_lineno);
   }
-  fputs(" | ", stderr);
+  fputs(" | ", diag_get_output());
 }
 
 void
@@ -269,7 +269,7 @@ p_diag_print_source_ranges(PSourceFile* p_file, PSourceRange* p_ranges, size_t p
     uint32_t current_lineno = partial_source_ranges[i].lineno;
     if (current_lineno != (prev_lineno + 1)) {
       print_line_margin(0);
-      fputs("...\n", stderr);
+      fputs("...\n", diag_get_output());
     }
 
     prev_lineno = current_lineno;
@@ -296,7 +296,7 @@ p_diag_print_source_ranges(PSourceFile* p_file, PSourceRange* p_ranges, size_t p
     }
 
     --i;
-    fputs("\n", stderr);
+    fputs("\n", diag_get_output());
   }
 }
 
@@ -315,7 +315,7 @@ p_diag_print_source_line(PSourceFile* p_file, uint32_t p_lineno)
   }
 
   print_line_margin(p_lineno);
-  fwrite(p_file->get_buffer_raw() + start_position, sizeof(char), line_length, stderr);
-  fputs("\n", stderr);
+  fwrite(p_file->get_buffer_raw() + start_position, sizeof(char), line_length, diag_get_output());
+  fputs("\n", diag_get_output());
   return line_length;
 }
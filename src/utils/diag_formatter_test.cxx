@@ -81,7 +81,7 @@ TEST(diag_formatter, ident_arg)
 
 TEST(diag_formatter, type_arg)
 {
-  auto& ctx = PContext::get_global();
+  PContext ctx;
 
   // Builtin type.
   PDiagArgument builtin_type;
@@ -0,0 +1,122 @@
+#include "diag.hxx"
+
+#include "../options.hxx"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Reports p_count errors, in the thread-local diagnostic context.
+static void
+report_errors(int p_count)
+{
+  for (int i = 0; i < p_count; ++i) {
+    PDiag* d = diag(P_DK_err_fail_open_file);
+    diag_add_arg_str(d, "foo");
+    diag_flush(d);
+  }
+}
+
+/// Returns the content of p_stream, a tmpfile().
+static std::string
+read_stream(FILE* p_stream)
+{
+  fflush(p_stream);
+  rewind(p_stream);
+  std::string content;
+  char buffer[256];
+  size_t read_bytes;
+  while ((read_bytes = fread(buffer, 1, sizeof(buffer), p_stream)) > 0)
+    content.append(buffer, read_bytes);
+  return content;
+}
+
+static size_t
+count_occurrences(const std::string& p_string, const std::string& p_pattern)
+{
+  size_t count = 0;
+  for (size_t pos = p_string.find(p_pattern); pos != std::string::npos; pos = p_string.find(p_pattern, pos + 1))
+    ++count;
+  return count;
+}
+
+class DiagTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_saved_context = g_diag_context;
+    m_saved_options = g_options;
+    g_diag_context.output = tmpfile();
+    g_diag_context.diagnostic_count[P_DIAG_ERROR] = 0;
+    g_options.opt_diagnostics_color = false;
+    diag_reset_error_limit();
+  }
+
+  void TearDown() override
+  {
+    fclose(g_diag_context.output);
+    g_diag_context = m_saved_context;
+    g_options = m_saved_options;
+    diag_reset_error_limit();
+  }
+
+  PDiagContext m_saved_context;
+  POptions m_saved_options;
+};
+
+TEST_F(DiagTest, max_errors)
+{
+  g_options.opt_diagnostics_max_errors = 3;
+  report_errors(5);
+
+  const std::string output = read_stream(g_diag_context.output);
+  EXPECT_EQ(count_occurrences(output, "failed to open file"), 3);
+  EXPECT_EQ(count_occurrences(output, "compilation terminated due to -fmax-errors=3."), 1);
+  EXPECT_TRUE(diag_is_compilation_stopped());
+  // The dropped errors are still counted.
+  EXPECT_EQ(g_diag_context.diagnostic_count[P_DIAG_ERROR], 5);
+}
+
+TEST_F(DiagTest, max_errors_across_threads)
+{
+  // The limit is for the whole compilation, not for each thread.
+  g_options.opt_diagnostics_max_errors = 10;
+
+  std::vector<FILE*> outputs(4);
+  std::vector<std::thread> threads;
+  for (auto& output : outputs) {
+    output = tmpfile();
+    threads.emplace_back([output]() {
+      g_diag_context.output = output;
+      report_errors(5);
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  std::string output;
+  for (FILE* stream : outputs) {
+    output += read_stream(stream);
+    fclose(stream);
+  }
+
+  EXPECT_EQ(count_occurrences(output, "failed to open file"), 10);
+  EXPECT_EQ(count_occurrences(output, "compilation terminated"), 1);
+  EXPECT_TRUE(diag_is_compilation_stopped());
+}
+
+TEST_F(DiagTest, fatal_errors)
+{
+  g_options.opt_w_fatal_erros = true;
+  EXPECT_FALSE(diag_is_compilation_stopped());
+  report_errors(2);
+
+  const std::string output = read_stream(g_diag_context.output);
+  EXPECT_EQ(count_occurrences(output, "failed to open file"), 1);
+  EXPECT_EQ(count_occurrences(output, "compilation terminated due to -Wfatal-errors."), 1);
+  EXPECT_TRUE(diag_is_compilation_stopped());
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "bump_allocator.hxx"
+#include "hash_table_common.hxx"
+
+#include <hedley.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/// The default hash function of PHashMap and PHashSet, for pointers, integers,
+/// enumerations and strings.
+template<class T>
+struct PHash
+{
+  [[nodiscard]] uint64_t operator()(const T& p_value) const noexcept
+  {
+    if constexpr (std::is_pointer_v<T>) {
+      return p_hash_mix(0, reinterpret_cast<uintptr_t>(p_value));
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+      return p_hash_string(p_value);
+    } else {
+      static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "no default hash function for this type");
+      return p_hash_mix(0, static_cast<uint64_t>(p_value));
+    }
+  }
+};
+
+/// \brief A hash map with open addressing, for trivially copyable keys and
+/// values.
+///
+/// The entries are stored inline in a single array (no allocation per entry,
+/// unlike std::unordered_map) and collisions are resolved by linear probing.
+/// A separate array stores one control byte per bucket: zero if the bucket is
+/// empty, or 7 bits of the hash of its key. Probing therefore only compares
+/// the keys whose control byte matches.
+///
+/// Items can not be removed one by one (only by clear()), so there are no
+/// tombstones. The pointers to the entries are invalidated when the table
+/// grows.
+///
+/// If an allocator is given, the buckets are allocated in it rather than
+/// with malloc(). The buckets replaced when the table grows are then only
+/// freed with the allocator, which at most doubles the memory used by the
+/// table. This is intended for tables that live as long as their allocator.
+///
+/// The Hash and Eq functions may be heterogeneous: find() and lazy_emplace()
+/// accept any key type Q for which Eq(K, Q) is defined, together with the
+/// hash of the key (which must be equal to the Hash of the equivalent K).
+template<class K, class V, class Hash = PHash<K>, class Eq = std::equal_to<>>
+class PHashMap
+{
+  static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>);
+  static_assert(std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>);
+
+public:
+  struct PEntry
+  {
+    K key;
+    [[no_unique_address]] V value;
+  };
+
+  PHashMap() = default;
+  explicit PHashMap(PBumpAllocator* p_allocator)
+    : m_allocator(p_allocator)
+  {
+  }
+  ~PHashMap()
+  {
+    if (m_allocator == nullptr)
+      free(m_entries);
+  }
+
+  PHashMap(const PHashMap&) = delete;
+  PHashMap& operator=(const PHashMap&) = delete;
+
+  /// Returns the count of items in the table.
+  [[nodiscard]] size_t size() const { return m_item_count; }
+  [[nodiscard]] bool empty() const { return m_item_count == 0; }
+  /// Returns the count of bytes allocated for the buckets.
+  [[nodiscard]] size_t get_memory_usage() const { return m_bucket_count * (sizeof(PEntry) + sizeof(uint8_t)); }
+
+  /// Returns the value of p_key, or nullptr if p_key is not in the table.
+  [[nodiscard]] V* find(const K& p_key) const { return find(p_key, m_hash(p_key)); }
+  template<class Q>
+  [[nodiscard]] V* find(const Q& p_key, uint64_t p_hash) const
+  {
+    PEntry* entry = find_entry(p_key, p_hash);
+    return entry != nullptr ? &entry->value : nullptr;
+  }
+  template<class Q>
+  [[nodiscard]] PEntry* find_entry(const Q& p_key, uint64_t p_hash) const
+  {
+    if (m_item_count == 0)
+      return nullptr;
+
+    const size_t index = find_index(p_key, p_hash);
+    return m_controls[index] != EMPTY ? &m_entries[index] : nullptr;
+  }
+
+  /// Inserts p_key with p_value if p_key is not already in the table. Returns
+  /// the entry of p_key and true if it was inserted.
+  std::pair<PEntry*, bool> insert(const K& p_key, const V& p_value) { return insert(p_key, m_hash(p_key), p_value); }
+  std::pair<PEntry*, bool> insert(const K& p_key, uint64_t p_hash, const V& p_value)
+  {
+    auto result = lazy_emplace(p_key, p_hash, [&p_key]() { return p_key; });
+    if (result.second)
+      result.first->value = p_value;
+    return result;
+  }
+
+  /// Returns the entry of p_key. If there is none, inserts the key returned
+  /// by p_make_key(), that must be equivalent to p_key, with a
+  /// value-initialized value. The second member is true if it was inserted.
+  ///
+  /// This allows to only allocate the key (e.g. a string) when it is not
+  /// already in the table.
+  template<class Q, class F>
+  std::pair<PEntry*, bool> lazy_emplace(const Q& p_key, uint64_t p_hash, F&& p_make_key)
+  {
+    if (HEDLEY_UNLIKELY(m_bucket_count == 0))
+      grow();
+
+    size_t index = find_index(p_key, p_hash);
+    if (m_controls[index] != EMPTY)
+      return { &m_entries[index], false };
+
+    const float max_item_count = P_MAX_LOAD_FACTOR * static_cast<float>(m_bucket_count);
+    if (HEDLEY_UNLIKELY(static_cast<float>(m_item_count + 1) > max_item_count)) {
+      grow();
+      index = find_index(p_key, p_hash);
+    }
+
+    m_controls[index] = get_control(p_hash);
+    m_entries[index] = PEntry{ std::forward<F>(p_make_key)(), V{} };
+    ++m_item_count;
+    return { &m_entries[index], true };
+  }
+
+  /// Removes all the items, but keeps the buckets.
+  void clear()
+  {
+    if (m_item_count != 0)
+      memset(m_controls, EMPTY, sizeof(uint8_t) * m_bucket_count);
+    m_item_count = 0;
+  }
+
+private:
+  static constexpr uint8_t EMPTY = 0;
+
+  /// Returns the control byte of an occupied bucket whose key hash is p_hash.
+  [[nodiscard]] static uint8_t get_control(uint64_t p_hash) { return 0x80 | (p_hash & 0x7F); }
+
+  /// Returns the index of the first bucket to probe for p_hash.
+  [[nodiscard]] size_t get_bucket_index(uint64_t p_hash) const
+  {
+    // Maps the high bits of the hash to [0, m_bucket_count) with a
+    // multiplication rather than a (much slower) modulo.
+    return static_cast<size_t>(((p_hash >> 32) * m_bucket_count) >> 32);
+  }
+
+  /// Returns the index of the bucket of p_key, or of the empty bucket where
+  /// to insert it.
+  template<class Q>
+  [[nodiscard]] size_t find_index(const Q& p_key, uint64_t p_hash) const
+  {
+    const uint8_t control = get_control(p_hash);
+    size_t index = get_bucket_index(p_hash);
+    while (true) {
+      const uint8_t bucket_control = m_controls[index];
+      if (bucket_control == EMPTY)
+        return index;
+      if (bucket_control == control && m_eq(m_entries[index].key, p_key))
+        return index;
+
+      if (++index == m_bucket_count)
+        index = 0;
+    }
+  }
+
+  void grow()
+  {
+    PEntry* old_entries = m_entries;
+    uint8_t* old_controls = m_controls;
+    const size_t old_bucket_count = m_bucket_count;
+
+    m_bucket_count = p_get_new_hash_table_size(old_bucket_count);
+    assert(m_bucket_count <= UINT32_MAX && "see get_bucket_index()");
+
+    // The entries and then the control bytes, in a single allocation.
+    const size_t size = m_bucket_count * (sizeof(PEntry) + sizeof(uint8_t));
+    if (m_allocator != nullptr)
+      m_entries = static_cast<PEntry*>(m_allocator->alloc(size, alignof(PEntry)));
+    else
+      m_entries = static_cast<PEntry*>(malloc(size));
+    assert(m_entries != nullptr);
+    m_controls = reinterpret_cast<uint8_t*>(m_entries + m_bucket_count);
+    memset(m_controls, EMPTY, sizeof(uint8_t) * m_bucket_count);
+
+    for (size_t i = 0; i < old_bucket_count; ++i) {
+      if (old_controls[i] == EMPTY)
+        continue;
+
+      const uint64_t hash = m_hash(old_entries[i].key);
+      size_t index = get_bucket_index(hash);
+      while (m_controls[index] != EMPTY) {
+        if (++index == m_bucket_count)
+          index = 0;
+      }
+
+      m_controls[index] = old_controls[i];
+      m_entries[index] = old_entries[i];
+    }
+
+    if (m_allocator == nullptr)
+      free(old_entries);
+  }
+
+  PBumpAllocator* m_allocator = nullptr;
+  PEntry* m_entries = nullptr;
+  uint8_t* m_controls = nullptr;
+  size_t m_bucket_count = 0;
+  size_t m_item_count = 0;
+  [[no_unique_address]] Hash m_hash;
+  [[no_unique_address]] Eq m_eq;
+};
+
+/// \brief A hash set with open addressing, for trivially copyable keys.
+///
+/// This is a PHashMap without values, see it for the details.
+template<class K, class Hash = PHash<K>, class Eq = std::equal_to<>>
+class PHashSet
+{
+public:
+  PHashSet() = default;
+  explicit PHashSet(PBumpAllocator* p_allocator)
+    : m_map(p_allocator)
+  {
+  }
+
+  [[nodiscard]] size_t size() const { return m_map.size(); }
+  [[nodiscard]] bool empty() const { return m_map.empty(); }
+  [[nodiscard]] size_t get_memory_usage() const { return m_map.get_memory_usage(); }
+
+  [[nodiscard]] bool contains(const K& p_key) const { return m_map.find(p_key) != nullptr; }
+  /// Returns the key of the set equivalent to p_key, or nullptr if there is
+  /// none.
+  template<class Q>
+  [[nodiscard]] const K* find(const Q& p_key, uint64_t p_hash) const
+  {
+    auto* entry = m_map.find_entry(p_key, p_hash);
+    return entry != nullptr ? &entry->key : nullptr;
+  }
+
+  /// Inserts p_key if it is not already in the set. Returns the key of the set
+  /// and true if it was inserted.
+  std::pair<const K*, bool> insert(const K& p_key)
+  {
+    auto [entry, inserted] = m_map.insert(p_key, {});
+    return { &entry->key, inserted };
+  }
+
+  /// Same as PHashMap::lazy_emplace().
+  template<class Q, class F>
+  std::pair<const K*, bool> lazy_emplace(const Q& p_key, uint64_t p_hash, F&& p_make_key)
+  {
+    auto [entry, inserted] = m_map.lazy_emplace(p_key, p_hash, std::forward<F>(p_make_key));
+    return { &entry->key, inserted };
+  }
+
+  void clear() { m_map.clear(); }
+
+private:
+  struct PEmpty
+  {
+  };
+
+  PHashMap<K, PEmpty, Hash, Eq> m_map;
+};
@@ -0,0 +1,240 @@
+#include "hash_map.hxx"
+
+#include "../parser.hxx"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Returns a large synthetic program of p_function_count functions, each with
+/// its own structure, pointer types, parameters and local variables.
+static std::string
+generate_program(size_t p_function_count)
+{
+  std::string program;
+  for (size_t i = 0; i < p_function_count; ++i) {
+    const std::string n = std::to_string(i);
+    program += "struct S" + n + " { x: i32, p: *i64 }\n";
+    program += "fn g" + n + "(c: *S" + n + ", d: **S" + n + ") -> i32 { return 0; }\n";
+    program += "fn h" + n + "(a: i32, b: *i64) -> i32 {\n";
+    program += "  let x0 = a + " + n + ";\n";
+    program += "  let x1: i32 = x0 * 2;\n";
+    program += "  let x2 = x1 - a;\n";
+    program += "  while x2 < 10 { let y = x2; x2 = y + x1; }\n";
+    program += "  return " + (i == 0 ? std::string("x0") : "h" + std::to_string(i - 1) + "(x1, b)") + " + x2;\n";
+    program += "}\n";
+  }
+
+  return program;
+}
+
+/// The identifiers of the synthetic program, split as in the scopes built by
+/// the semantic analysis: the global scope with the name of each structure and
+/// function, and a local scope for each of them.
+struct PProgramScopes
+{
+  struct PItem
+  {
+    // The distinct identifiers declared in the local scope.
+    std::vector<PIdentifierInfo*> locals;
+    // All the identifiers referenced in the item, in order.
+    std::vector<PIdentifierInfo*> references;
+  };
+
+  std::string source;
+  PIdentifierTable identifier_table;
+  std::vector<PIdentifierInfo*> globals;
+  std::vector<PItem> items;
+
+  explicit PProgramScopes(size_t p_function_count)
+    : source(generate_program(p_function_count))
+  {
+    PSourceFile source_file("<bench-input>", source);
+    PLexer lexer;
+    lexer.identifier_table = &identifier_table;
+    lexer.set_source_file(&source_file);
+
+    PHashSet<PIdentifierInfo*> global_set;
+    PTokenKind previous_kind = P_TOK_EOF;
+    PToken token;
+    do {
+      lexer.tokenize(token);
+      if (token.kind == P_TOK_KEY_fn || token.kind == P_TOK_KEY_struct)
+        items.emplace_back();
+
+      if (token.kind == P_TOK_IDENTIFIER) {
+        if (previous_kind == P_TOK_KEY_fn || previous_kind == P_TOK_KEY_struct) {
+          global_set.insert(token.data.identifier);
+          globals.push_back(token.data.identifier);
+        } else {
+          items.back().references.push_back(token.data.identifier);
+        }
+      }
+
+      previous_kind = token.kind;
+    } while (token.kind != P_TOK_EOF);
+
+    // Every identifier that does not reference a global is a local one.
+    for (auto& item : items) {
+      PHashSet<PIdentifierInfo*> local_set;
+      for (auto* identifier : item.references) {
+        if (!global_set.contains(identifier) && local_set.insert(identifier).second)
+          item.locals.push_back(identifier);
+      }
+    }
+  }
+};
+
+static size_t g_allocated_bytes = 0;
+
+/// A std::allocator that counts the bytes currently allocated, to measure the
+/// memory used by std::unordered_map. The overhead of malloc() itself (at
+/// least 8 bytes per node) is not counted.
+template<class T>
+struct PCountingAllocator
+{
+  using value_type = T;
+
+  PCountingAllocator() = default;
+  template<class U>
+  PCountingAllocator(const PCountingAllocator<U>&)
+  {
+  }
+
+  T* allocate(size_t p_n)
+  {
+    g_allocated_bytes += sizeof(T) * p_n;
+    return std::allocator<T>{}.allocate(p_n);
+  }
+  void deallocate(T* p_ptr, size_t p_n)
+  {
+    g_allocated_bytes -= sizeof(T) * p_n;
+    std::allocator<T>{}.deallocate(p_ptr, p_n);
+  }
+
+  template<class U>
+  bool operator==(const PCountingAllocator<U>&) const
+  {
+    return true;
+  }
+};
+
+/// The previous symbol table of PScope, used as a baseline.
+class PBaselineSymbolMap
+{
+public:
+  void insert(PIdentifierInfo* p_key, PSymbol* p_value) { m_map.insert({ p_key, p_value }); }
+  PSymbol* find(PIdentifierInfo* p_key) const
+  {
+    const auto it = m_map.find(p_key);
+    return it != m_map.end() ? it->second : nullptr;
+  }
+
+private:
+  std::unordered_map<PIdentifierInfo*,
+                     PSymbol*,
+                     std::hash<PIdentifierInfo*>,
+                     std::equal_to<>,
+                     PCountingAllocator<std::pair<PIdentifierInfo* const, PSymbol*>>>
+    m_map;
+};
+
+class PSymbolMap
+{
+public:
+  void insert(PIdentifierInfo* p_key, PSymbol* p_value) { m_map.insert(p_key, p_value); }
+  PSymbol* find(PIdentifierInfo* p_key) const
+  {
+    PSymbol** value = m_map.find(p_key);
+    return value != nullptr ? *value : nullptr;
+  }
+
+  size_t get_memory_usage() const { return m_map.get_memory_usage(); }
+
+private:
+  PHashMap<PIdentifierInfo*, PSymbol*> m_map;
+};
+
+/// Resolves each identifier referenced by the synthetic program, as the
+/// semantic analysis does: a symbol table is built for the local scope of each
+/// structure and function, then the identifiers are looked up in it and then
+/// in the global scope.
+template<class Map>
+static void
+run_symbol_lookup_benchmark(benchmark::State& p_state)
+{
+  const PProgramScopes program(p_state.range(0));
+  PSymbol symbol(nullptr, nullptr);
+
+  const size_t allocated_bytes = g_allocated_bytes;
+  Map global_scope;
+  for (auto* identifier : program.globals)
+    global_scope.insert(identifier, &symbol);
+
+  size_t memory_usage;
+  if constexpr (std::is_same_v<Map, PSymbolMap>)
+    memory_usage = global_scope.get_memory_usage();
+  else
+    memory_usage = g_allocated_bytes - allocated_bytes;
+
+  size_t lookup_count = 0;
+  for (auto _ : p_state) {
+    for (const auto& item : program.items) {
+      Map local_scope;
+      for (auto* identifier : item.locals)
+        local_scope.insert(identifier, &symbol);
+
+      for (auto* identifier : item.references) {
+        PSymbol* found = local_scope.find(identifier);
+        if (found == nullptr)
+          found = global_scope.find(identifier);
+        benchmark::DoNotOptimize(found);
+      }
+
+      lookup_count += item.references.size();
+    }
+  }
+
+  p_state.SetItemsProcessed(lookup_count);
+  // The memory used by the global scope.
+  p_state.counters["bytes_per_entry"] = static_cast<double>(memory_usage) / static_cast<double>(program.globals.size());
+}
+
+static void
+BM_symbol_lookup(benchmark::State& p_state)
+{
+  run_symbol_lookup_benchmark<PSymbolMap>(p_state);
+}
+BENCHMARK(BM_symbol_lookup)->Arg(1000)->Arg(50000);
+
+static void
+BM_symbol_lookup_baseline(benchmark::State& p_state)
+{
+  run_symbol_lookup_benchmark<PBaselineSymbolMap>(p_state);
+}
+BENCHMARK(BM_symbol_lookup_baseline)->Arg(1000)->Arg(50000);
+
+/// Lexes, parses and analyzes the synthetic program: the symbols of each
+/// scope, the identifiers and the types are all stored in PHashMap.
+static void
+BM_parse_synthetic_program(benchmark::State& p_state)
+{
+  const std::string source = generate_program(p_state.range(0));
+  PSourceFile source_file("<bench-input>", source);
+
+  for (auto _ : p_state) {
+    PIdentifierTable identifier_table;
+    PLexer lexer;
+    lexer.identifier_table = &identifier_table;
+    lexer.set_source_file(&source_file);
+
+    PContext context;
+    PParser parser(context, lexer);
+    benchmark::DoNotOptimize(parser.parse());
+  }
+
+  p_state.SetBytesProcessed(p_state.iterations() * source.size());
+}
+BENCHMARK(BM_parse_synthetic_program)->Arg(50000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,136 @@
+#include "hash_map.hxx"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+TEST(hash_map, find_and_insert)
+{
+  PHashMap<int, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find(1), nullptr);
+
+  auto [entry, inserted] = map.insert(1, 10);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(entry->key, 1);
+  EXPECT_EQ(entry->value, 10);
+
+  // Existing keys are not replaced.
+  auto [same_entry, inserted_again] = map.insert(1, 20);
+  EXPECT_FALSE(inserted_again);
+  EXPECT_EQ(same_entry->value, 10);
+
+  ASSERT_NE(map.find(1), nullptr);
+  EXPECT_EQ(*map.find(1), 10);
+  EXPECT_EQ(map.find(2), nullptr);
+  EXPECT_EQ(map.size(), 1);
+}
+
+TEST(hash_map, grow)
+{
+  // Pointers are aligned, their low bits are all zeros.
+  std::vector<double> objects(10000);
+  PHashMap<const double*, size_t> map;
+  for (size_t i = 0; i < objects.size(); ++i)
+    EXPECT_TRUE(map.insert(&objects[i], i).second);
+
+  EXPECT_EQ(map.size(), objects.size());
+  EXPECT_GE(map.get_memory_usage(), objects.size() * (sizeof(void*) + sizeof(size_t)));
+  for (size_t i = 0; i < objects.size(); ++i) {
+    ASSERT_NE(map.find(&objects[i]), nullptr);
+    EXPECT_EQ(*map.find(&objects[i]), i);
+  }
+
+  EXPECT_EQ(map.find(objects.data() + objects.size()), nullptr);
+}
+
+TEST(hash_map, same_as_unordered_map)
+{
+  // Small keys to have many collisions and existing keys.
+  PHashMap<uint32_t, uint32_t> map;
+  std::unordered_map<uint32_t, uint32_t> expected;
+  uint32_t state = 1;
+  for (uint32_t i = 0; i < 20000; ++i) {
+    state = state * 1103515245 + 12345;
+    const uint32_t key = (state >> 8) % 5000;
+    EXPECT_EQ(map.insert(key, i).second, expected.insert({ key, i }).second);
+  }
+
+  EXPECT_EQ(map.size(), expected.size());
+  for (uint32_t key = 0; key < 5000; ++key) {
+    const auto it = expected.find(key);
+    if (it == expected.end()) {
+      EXPECT_EQ(map.find(key), nullptr);
+    } else {
+      ASSERT_NE(map.find(key), nullptr);
+      EXPECT_EQ(*map.find(key), it->second);
+    }
+  }
+}
+
+TEST(hash_map, clear)
+{
+  PHashMap<int, int> map;
+  for (int i = 0; i < 100; ++i)
+    map.insert(i, i);
+
+  const size_t memory_usage = map.get_memory_usage();
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find(5), nullptr);
+  EXPECT_EQ(map.get_memory_usage(), memory_usage);
+
+  EXPECT_TRUE(map.insert(5, 6).second);
+  EXPECT_EQ(*map.find(5), 6);
+}
+
+TEST(hash_map, allocator)
+{
+  PBumpAllocator allocator;
+  PHashMap<int, int> map(&allocator);
+  for (int i = 0; i < 1000; ++i)
+    map.insert(i, -i);
+
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(*map.find(i), -i);
+}
+
+TEST(hash_set, lazy_emplace)
+{
+  // Strings only copied when inserted, looked up by std::string_view.
+  std::vector<std::string> storage;
+  storage.reserve(10);
+  PHashSet<std::string_view> set;
+  const auto intern = [&](std::string_view p_string) {
+    return set.lazy_emplace(p_string, p_hash_string(p_string), [&]() {
+      return std::string_view(storage.emplace_back(p_string));
+    });
+  };
+
+  auto [foo, inserted] = intern("foo");
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(*foo, "foo");
+  EXPECT_EQ(foo->data(), storage[0].data());
+
+  std::string foo_again = "foo";
+  auto [same_foo, inserted_again] = intern(foo_again);
+  EXPECT_FALSE(inserted_again);
+  EXPECT_EQ(same_foo->data(), storage[0].data());
+  EXPECT_EQ(storage.size(), 1);
+
+  EXPECT_TRUE(intern("bar").second);
+  EXPECT_TRUE(set.contains("bar"));
+  EXPECT_FALSE(set.contains("baz"));
+  EXPECT_EQ(set.find(std::string_view("foo"), p_hash_string("foo")), same_foo);
+  EXPECT_EQ(set.size(), 2);
+}
+
+TEST(hash_set, empty_value)
+{
+  // The entries of a set are only the keys.
+  PHashSet<void*> set;
+  set.insert(nullptr);
+  EXPECT_EQ(set.get_memory_usage() % (sizeof(void*) + 1), 0);
+}
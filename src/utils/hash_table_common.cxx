@@ -1,36 +1,54 @@
 #include "hash_table_common.hxx"
 
-#include <cassert>
-#include <cstdlib>
 #include <cstring>
 
 size_t
 p_get_new_hash_table_size(size_t p_old_size)
 {
-  /* From https://www.planetmath.org/goodhashtableprimes */
-  static size_t prime_sizes[] = {
-    53,        97,        193,       389,       769,        1543,     3079,
-    6151,      12289,     24593,     49157,     98317,      196613,   393241,
-    786433,    1572869,   3145739,   6291469,   12582917,   25165843, 50331653,
-    100663319, 201326611, 402653189, 805306457, 1610612741,
-  };
-
-  for (unsigned long prime_size : prime_sizes) {
-    if (prime_size > p_old_size)
-      return prime_size;
-  }
-
-  /* If there is not enough prime sizes just fallback to a naive growth
-   * strategy. */
+  /* The buckets are selected by a multiplication (see PHashMap) and not by
+   * a modulo, so there is no need for prime sizes. Start small as most
+   * tables (e.g. the symbols of a scope) only have a few items. */
+  constexpr size_t MIN_SIZE = 8;
+  if (p_old_size < MIN_SIZE)
+    return MIN_SIZE;
   return p_old_size * 2;
 }
 
-void**
-p_alloc_buckets(size_t p_count, size_t p_bucket_size)
+template<class T>
+static inline uint64_t
+load(const char* p_ptr)
 {
-  const size_t size = p_count * p_bucket_size;
-  void** buckets = static_cast<void**>(malloc(size));
-  assert(buckets != nullptr);
-  memset(buckets, 0, size);
-  return buckets;
+  T value;
+  memcpy(&value, p_ptr, sizeof(value));
+  return value;
+}
+
+uint64_t
+p_hash_string(std::string_view p_string)
+{
+  // Identifiers are short: read them with a few fixed-size (and possibly
+  // overlapping) loads rather than a loop, whose trip count and tail would
+  // depend on the length and be badly predicted.
+  const char* data = p_string.data();
+  const size_t size = p_string.size();
+
+  uint64_t hash = p_hash_mix(0, size);
+  if (size > 16) {
+    for (size_t i = 0; i + 16 < size; i += 8)
+      hash = p_hash_mix(hash, load<uint64_t>(data + i));
+    hash = p_hash_mix(hash, load<uint64_t>(data + size - 16));
+    hash = p_hash_mix(hash, load<uint64_t>(data + size - 8));
+  } else if (size >= 8) {
+    hash = p_hash_mix(hash, load<uint64_t>(data));
+    hash = p_hash_mix(hash, load<uint64_t>(data + size - 8));
+  } else if (size >= 4) {
+    hash = p_hash_mix(hash, (load<uint32_t>(data) << 32) | load<uint32_t>(data + size - 4));
+  } else if (size > 0) {
+    const auto first = static_cast<unsigned char>(data[0]);
+    const auto middle = static_cast<unsigned char>(data[size / 2]);
+    const auto last = static_cast<unsigned char>(data[size - 1]);
+    hash = p_hash_mix(hash, (first << 16) | (middle << 8) | last);
+  }
+
+  return hash;
 }
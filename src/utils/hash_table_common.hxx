@@ -1,27 +1,34 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 /*
  * This file contains common functions and constants to all hash table
- * implementations that can be found in this source tree.
- *
- * FIXME: Merge all different hash table implementations.
+ * implementations that can be found in this source tree (see PHashMap in
+ * hash_map.hxx).
  */
 
 #define P_MAX_LOAD_FACTOR 0.7f
-#define P_GET_LOAD_FACTOR(p_table)                                             \
-  ((float)(p_table)->item_count / (float)(p_table)->bucket_count)
-#define P_NEEDS_REHASHING(p_table)                                             \
-  (P_GET_LOAD_FACTOR(p_table) > P_MAX_LOAD_FACTOR)
 
 /* Returns a new suitable count of buckets for a growing hash
  * table. */
 size_t
 p_get_new_hash_table_size(size_t p_old_size);
 
-void**
-p_alloc_buckets(size_t p_count, size_t p_bucket_size);
+/// Returns p_hash updated with p_word. Each bit of the result depends on
+/// (almost) all the bits of both inputs, so the high bits can be used to
+/// select a bucket and the low bits as a tag.
+[[nodiscard]] inline uint64_t
+p_hash_mix(uint64_t p_hash, uint64_t p_word)
+{
+  constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15; // 2^64 / golden ratio
+  p_hash = (p_hash ^ p_word) * MULTIPLIER;
+  return p_hash ^ (p_hash >> 32);
+}
 
-#define P_ALLOC_BUCKETS(p_count, p_type)                                       \
-  (p_type*)p_alloc_buckets((p_count), sizeof(p_type))
+/// Returns the hash of the p_string bytes, optimized for short strings such
+/// as identifiers.
+[[nodiscard]] uint64_t
+p_hash_string(std::string_view p_string);
@@ -1,17 +1,44 @@
 #include "line_map.hxx"
 
+#include "char_scan.hxx"
+
 #include <cassert>
 #include <algorithm>
 
+// Used to estimate the number of lines of a buffer to reserve the memory in
+// advance, even if source files often have shorter lines.
+#define P_AVERAGE_LINE_LENGTH_ESTIMATE 32
+
 void
 PLineMap::add(uint32_t p_line_pos)
 {
   m_positions.push_back(p_line_pos);
 }
 
+static void
+add_line_starts(std::string_view p_buffer, std::vector<uint32_t>& p_positions)
+{
+  p_positions.reserve(p_positions.size() + p_buffer.size() / P_AVERAGE_LINE_LENGTH_ESTIMATE);
+  p_find_line_starts(p_buffer.data(), p_buffer.data() + p_buffer.size(), p_positions);
+}
+
+void
+PLineMap::add_all(std::string_view p_buffer)
+{
+  add_line_starts(p_buffer, m_positions);
+}
+
+void
+PLineMap::ensure_built() const
+{
+  std::call_once(m_built_flag, [this] { add_line_starts(m_buffer, m_positions); });
+}
+
 void
 PLineMap::get_lineno_and_colno(uint32_t p_position, uint32_t* p_lineno, uint32_t* p_colno) const
 {
+  ensure_built();
+
   // Handle simple cases:
   if (m_positions.empty() || p_position < m_positions[0]) {
     if (p_lineno)
@@ -54,6 +81,7 @@ PLineMap::get_colno(uint32_t p_position) const
 uint32_t
 PLineMap::get_line_start_pos(uint32_t p_lineno) const
 {
+  ensure_built();
   assert(p_lineno > 0 && p_lineno <= (m_positions.size() + 1));
 
   if (p_lineno == 1)
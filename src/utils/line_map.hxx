@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <mutex>
+#include <string_view>
 #include <vector>
 
 /// PLineMap provides functions to convert between character positions and line
@@ -9,17 +11,31 @@
 /// Character m_positions are a 0-based byte offset in the source file.
 /// Line and column numbers are 1-based like many code editors for convenience.
 ///
-/// The line map is populated by the lexer calling the PLineMap::add()
-/// function. This one takes as a parameter the position of the beginning of a
-/// new line with the constraint that the new position MUST BE greater than
-/// the previous reported position (that way the internal line map m_positions
-/// are guaranteed to be sorted).
+/// The line map of a source file is built lazily: PSourceFile gives its buffer
+/// with PLineMap::set_buffer() and the lines are only searched the first time
+/// the line map is queried (by diagnostics or debug information). Most
+/// compilations never query most of their line maps.
+///
+/// The line map can also be populated by calling PLineMap::add_all() with a
+/// whole buffer, or the PLineMap::add() function for each line. This one takes
+/// as a parameter the position of the beginning of a new line with the
+/// constraint that the new position MUST BE greater than the previous reported
+/// position (that way the internal line map m_positions are guaranteed to be
+/// sorted).
 class PLineMap
 {
 public:
+  /// Sets the buffer (the whole content of the source file) whose lines are
+  /// registered the first time the line map is queried. The buffer must
+  /// outlive the line map.
+  void set_buffer(std::string_view p_buffer) { m_buffer = p_buffer; }
+
   /// Adds a new line position (the position of the first byte of the newline, that is the position
   /// just after the character `\n` or `\r\n`).
   void add(uint32_t p_line_pos);
+  /// Adds the positions of all the lines of p_buffer, the whole content of the
+  /// source file. This is much faster than calling add() for each line.
+  void add_all(std::string_view p_buffer);
 
   /// Gets the line and column number corresponding to the given `p_pos` byte position.
   /// The parameters `p_lineno` or `p_colno` can be nullptr if the corresponding information is not needed.
@@ -32,9 +48,18 @@ public:
   /// Gets the position of the first byte at the given line.
   [[nodiscard]] uint32_t get_line_start_pos(uint32_t p_lineno) const;
 
+  /// Returns the count of bytes allocated for the line positions (zero if the
+  /// line map was never queried).
+  [[nodiscard]] size_t get_memory_usage() const { return m_positions.capacity() * sizeof(uint32_t); }
+
 private:
+  /// Registers the lines of m_buffer, if not already done.
+  void ensure_built() const;
   /// Does a binary search on the positions.
   [[nodiscard]] uint32_t search_rightmost(uint32_t p_pos) const;
 
-  std::vector<uint32_t> m_positions;
+  // Built on the first query, possibly by several threads.
+  mutable std::vector<uint32_t> m_positions;
+  mutable std::once_flag m_built_flag;
+  std::string_view m_buffer;
 };
@@ -68,3 +68,28 @@ TEST(line_map, get_line_start_position)
   EXPECT_EQ(lm.get_line_start_pos(2), 50);
   EXPECT_EQ(lm.get_line_start_pos(3), 100);
 }
+
+TEST(line_map, add_all)
+{
+  PLineMap lm;
+
+  lm.add_all("ab\ncd\r\n\nef");
+
+  EXPECT_EQ(lm.get_line_start_pos(2), 3);
+  EXPECT_EQ(lm.get_line_start_pos(3), 7);
+  EXPECT_EQ(lm.get_line_start_pos(4), 8);
+  EXPECT_EQ(lm.get_lineno(9), 4);
+  EXPECT_EQ(lm.get_colno(9), 2);
+}
+
+TEST(line_map, set_buffer)
+{
+  PLineMap lm;
+
+  // The lines are only searched once queried.
+  lm.set_buffer("ab\ncd\n");
+
+  EXPECT_EQ(lm.get_lineno(4), 2);
+  EXPECT_EQ(lm.get_colno(4), 2);
+  EXPECT_EQ(lm.get_line_start_pos(3), 6);
+}
@@ -0,0 +1,150 @@
+#include "mem_report.hxx"
+
+#include <hedley.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+static std::mutex g_mem_report_mutex;
+static std::map<std::string, PMemRecord, std::less<>> g_mem_report[P_MEM_GROUP_LAST];
+
+void
+mem_report_add(PMemGroup p_group, std::string_view p_name, size_t p_bytes, size_t p_count)
+{
+  std::lock_guard lock(g_mem_report_mutex);
+  auto& entries = g_mem_report[p_group];
+  auto it = entries.find(p_name);
+  if (it == entries.end())
+    it = entries.emplace(std::string(p_name), PMemRecord{}).first;
+
+  it->second.bytes += p_bytes;
+  it->second.count += p_count;
+}
+
+PMemRecord
+mem_report_get(PMemGroup p_group, std::string_view p_name)
+{
+  std::lock_guard lock(g_mem_report_mutex);
+  auto& entries = g_mem_report[p_group];
+  auto it = entries.find(p_name);
+  if (it == entries.end())
+    return {};
+  return it->second;
+}
+
+void
+mem_report_clear()
+{
+  std::lock_guard lock(g_mem_report_mutex);
+  for (auto& entries : g_mem_report)
+    entries.clear();
+}
+
+size_t
+mem_report_get_peak_rss()
+{
+#ifdef _WIN32
+  return 0;
+#else
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss); // in bytes
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024; // in KiB
+#endif
+#endif
+}
+
+static const char*
+get_mem_group_title(PMemGroup p_group)
+{
+  switch (p_group) {
+    case P_MEM_GROUP_STMTS:
+      return "AST statements and expressions";
+    case P_MEM_GROUP_DECLS:
+      return "AST declarations";
+    case P_MEM_GROUP_TYPES:
+      return "Types";
+    case P_MEM_GROUP_OTHER:
+      return "Other compiler data";
+    case P_MEM_GROUP_LLVM_MODULE:
+      return "LLVM modules";
+    default:
+      HEDLEY_UNREACHABLE_RETURN("");
+  }
+}
+
+static void
+print_mem_group(FILE* p_stream, PMemGroup p_group)
+{
+  const auto& entries = g_mem_report[p_group];
+  if (entries.empty())
+    return;
+
+  std::vector<std::pair<std::string_view, PMemRecord>> sorted_entries(entries.begin(), entries.end());
+  std::stable_sort(sorted_entries.begin(), sorted_entries.end(), [](const auto& p_lhs, const auto& p_rhs) {
+    if (p_lhs.second.bytes != p_rhs.second.bytes)
+      return p_lhs.second.bytes > p_rhs.second.bytes;
+    return p_lhs.second.count > p_rhs.second.count;
+  });
+
+  PMemRecord total;
+  for (const auto& [name, record] : sorted_entries) {
+    total.bytes += record.bytes;
+    total.count += record.count;
+  }
+
+  fprintf(p_stream, "===%s===\n", std::string(72, '-').c_str());
+  fprintf(p_stream, "  %s\n", get_mem_group_title(p_group));
+  fprintf(p_stream, "===%s===\n", std::string(72, '-').c_str());
+
+  // The LLVM objects are not allocated by us, only their count is known.
+  if (p_group == P_MEM_GROUP_LLVM_MODULE) {
+    fprintf(p_stream, "   ----Count----  --Name--\n");
+    for (const auto& [name, record] : sorted_entries)
+      fprintf(p_stream, "  %14zu  %.*s\n", record.count, (int)name.size(), name.data());
+    fprintf(p_stream, "\n");
+    return;
+  }
+
+  // Avoid divisions by zero when computing the percentages.
+  const double total_bytes = static_cast<double>(std::max<size_t>(total.bytes, 1));
+
+  fprintf(p_stream, "  Total: %zu bytes (%.2f MiB)\n\n", total.bytes, static_cast<double>(total.bytes) / (1 << 20));
+  fprintf(p_stream, "   ---------Bytes---------   ----Count----  --Name--\n");
+
+  for (const auto& [name, record] : sorted_entries) {
+    fprintf(p_stream,
+            "  %14zu (%5.1f%%)   %13zu  %.*s\n",
+            record.bytes,
+            static_cast<double>(record.bytes) * 100.0 / total_bytes,
+            record.count,
+            (int)name.size(),
+            name.data());
+  }
+
+  fprintf(p_stream, "  %14zu (100.0%%)   %13zu  Total\n\n", total.bytes, total.count);
+}
+
+void
+mem_report_print(FILE* p_stream)
+{
+  {
+    std::lock_guard lock(g_mem_report_mutex);
+    for (int i = 0; i < P_MEM_GROUP_LAST; ++i)
+      print_mem_group(p_stream, (PMemGroup)i);
+  }
+
+  const size_t peak_rss = mem_report_get_peak_rss();
+  if (peak_rss != 0)
+    fprintf(p_stream, "  Peak resident set size: %.2f MiB\n\n", static_cast<double>(peak_rss) / (1 << 20));
+}
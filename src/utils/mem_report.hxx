@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+/// The tables of the memory report (-fmem-report).
+enum PMemGroup
+{
+  P_MEM_GROUP_STMTS,       // AST statements and expressions, by PStmtKind
+  P_MEM_GROUP_DECLS,       // AST declarations, by PDeclKind
+  P_MEM_GROUP_TYPES,       // types, by PTypeKind
+  P_MEM_GROUP_OTHER,       // identifiers, scopes, tokens, line maps, ...
+  P_MEM_GROUP_LLVM_MODULE, // size of the generated LLVM modules (counts only)
+
+  P_MEM_GROUP_LAST
+};
+
+/// Accumulated memory of a memory report entry.
+struct PMemRecord
+{
+  size_t bytes = 0;
+  size_t count = 0; // count of objects
+};
+
+/// Adds p_bytes and p_count to the entry p_name of the memory report. The
+/// entries of all the translation units are summed. Thread-safe.
+void
+mem_report_add(PMemGroup p_group, std::string_view p_name, size_t p_bytes, size_t p_count);
+
+/// Returns the accumulated memory of the given entry (zero if not found).
+PMemRecord
+mem_report_get(PMemGroup p_group, std::string_view p_name);
+
+/// Removes all the entries of the memory report.
+void
+mem_report_clear();
+
+/// Returns the maximum resident set size of the process in bytes, or 0 if it
+/// is unknown on this platform.
+size_t
+mem_report_get_peak_rss();
+
+/// Prints the memory report tables and the peak resident set size to p_stream.
+void
+mem_report_print(FILE* p_stream);
@@ -0,0 +1,55 @@
+#include "mem_report.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <vector>
+
+TEST(mem_report, accumulate)
+{
+  mem_report_clear();
+
+  mem_report_add(P_MEM_GROUP_STMTS, "P_SK_CALL_EXPR", 100, 2);
+  mem_report_add(P_MEM_GROUP_STMTS, "P_SK_CALL_EXPR", 50, 1);
+  mem_report_add(P_MEM_GROUP_TYPES, "P_SK_CALL_EXPR", 10, 1);
+
+  EXPECT_EQ(mem_report_get(P_MEM_GROUP_STMTS, "P_SK_CALL_EXPR").bytes, 150u);
+  EXPECT_EQ(mem_report_get(P_MEM_GROUP_STMTS, "P_SK_CALL_EXPR").count, 3u);
+  EXPECT_EQ(mem_report_get(P_MEM_GROUP_TYPES, "P_SK_CALL_EXPR").bytes, 10u);
+  EXPECT_EQ(mem_report_get(P_MEM_GROUP_DECLS, "P_SK_CALL_EXPR").count, 0u);
+
+  mem_report_clear();
+  EXPECT_EQ(mem_report_get(P_MEM_GROUP_STMTS, "P_SK_CALL_EXPR").bytes, 0u);
+}
+
+TEST(mem_report, print)
+{
+  mem_report_clear();
+  mem_report_add(P_MEM_GROUP_DECLS, "P_DK_FUNCTION", 4096, 32);
+  mem_report_add(P_MEM_GROUP_LLVM_MODULE, "Instructions", 0, 1234);
+
+  FILE* stream = tmpfile();
+  ASSERT_NE(stream, nullptr);
+  mem_report_print(stream);
+
+  std::vector<char> output(ftell(stream) + 1, '\0');
+  rewind(stream);
+  ASSERT_EQ(fread(output.data(), 1, output.size() - 1, stream), output.size() - 1);
+  fclose(stream);
+
+  const std::string_view text(output.data());
+  EXPECT_NE(text.find("AST declarations"), std::string_view::npos);
+  EXPECT_NE(text.find("P_DK_FUNCTION"), std::string_view::npos);
+  EXPECT_NE(text.find("1234  Instructions"), std::string_view::npos);
+  // Empty groups are not printed.
+  EXPECT_EQ(text.find("Types"), std::string_view::npos);
+
+  mem_report_clear();
+}
+
+#ifndef _WIN32
+TEST(mem_report, peak_rss)
+{
+  EXPECT_GT(mem_report_get_peak_rss(), 0u);
+}
+#endif
@@ -4,10 +4,47 @@
 #include <filesystem>
 #include <memory>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Files smaller than this are copied into memory, mapping them costs more than
+// reading them.
+#define P_SOURCE_FILE_MMAP_MIN_SIZE (16 * 1024)
+
 PSourceFile::PSourceFile(std::string p_path, std::string p_content)
   : m_line_map()
   , m_path(std::move(p_path))
-  , m_buffer(std::move(p_content))
+  , m_content(std::move(p_content))
+  , m_buffer(m_content)
+{
+  init_filename();
+  m_line_map.set_buffer(m_buffer);
+}
+
+PSourceFile::PSourceFile(std::string p_path, void* p_mapping, size_t p_size)
+  : m_line_map()
+  , m_path(std::move(p_path))
+  , m_mapping(p_mapping)
+  , m_mapping_size(p_size)
+  , m_buffer(static_cast<const char*>(p_mapping), p_size)
+{
+  init_filename();
+  m_line_map.set_buffer(m_buffer);
+}
+
+PSourceFile::~PSourceFile()
+{
+#ifndef _WIN32
+  if (m_mapping != nullptr)
+    munmap(m_mapping, m_mapping_size);
+#endif
+}
+
+void
+PSourceFile::init_filename()
 {
   if (std::filesystem::exists(m_path)) {
     m_filename = std::filesystem::path(m_path).filename().string();
@@ -16,6 +53,36 @@ PSourceFile::PSourceFile(std::string p_path, std::string p_content)
   }
 }
 
+#ifndef _WIN32
+/// Maps the file read-only if it is worth it. The lexer requires the buffer
+/// to be NUL-terminated: the end of the last page, past the end of the file,
+/// is filled with zeros by the kernel. However, if the file size is a multiple
+/// of the page size, there is no such padding and nullptr is returned (the
+/// file is then copied in memory).
+static void*
+map_file(FILE* p_stream, size_t p_size)
+{
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  if (p_size < P_SOURCE_FILE_MMAP_MIN_SIZE || p_size % page_size == 0)
+    return nullptr;
+
+  void* mapping = mmap(nullptr, p_size, PROT_READ, MAP_PRIVATE, fileno(p_stream), 0);
+  if (mapping == MAP_FAILED)
+    return nullptr;
+
+  // The padding holds the bytes of the file instead of zeros if the file grew
+  // since p_size was queried.
+  if (static_cast<const char*>(mapping)[p_size] != '\0') {
+    munmap(mapping, p_size);
+    return nullptr;
+  }
+
+  // The lexer reads the file once from start to end.
+  madvise(mapping, p_size, MADV_SEQUENTIAL);
+  return mapping;
+}
+#endif
+
 std::unique_ptr<PSourceFile>
 PSourceFile::open(std::string p_filename)
 {
@@ -23,6 +90,17 @@ PSourceFile::open(std::string p_filename)
   if (stream == nullptr)
     return nullptr;
 
+#ifndef _WIN32
+  struct stat status;
+  if (fstat(fileno(stream), &status) == 0 && S_ISREG(status.st_mode)) {
+    void* mapping = map_file(stream, status.st_size);
+    if (mapping != nullptr) {
+      fclose(stream); // the mapping remains valid
+      return std::unique_ptr<PSourceFile>(new PSourceFile(std::move(p_filename), mapping, status.st_size));
+    }
+  }
+#endif
+
   fseek(stream, 0, SEEK_END);
   const auto bufsize = (size_t)ftell(stream);
   fseek(stream, 0, SEEK_SET);
@@ -3,27 +3,48 @@
 #include "line_map.hxx"
 
 #include <string>
+#include <string_view>
 #include <memory>
 
 /// A file that can be used as input for the lexer.
+///
+/// The buffer is always followed by a NUL character, which the lexer uses to
+/// detect the end of the input.
 struct PSourceFile
 {
   PSourceFile(std::string p_path, std::string p_content);
+  ~PSourceFile();
 
+  PSourceFile(const PSourceFile&) = delete;
+  PSourceFile& operator=(const PSourceFile&) = delete;
+
+  /// Opens the file p_filename. Large files are memory-mapped rather than
+  /// copied into memory. Returns nullptr if the file can not be read.
   static std::unique_ptr<PSourceFile> open(std::string p_filename);
 
   [[nodiscard]] const char* get_buffer_raw() const { return m_buffer.data(); }
-  [[nodiscard]] const std::string& get_buffer() const { return m_buffer; }
+  [[nodiscard]] std::string_view get_buffer() const { return m_buffer; }
   [[nodiscard]] const std::string& get_filename() const { return m_filename; }
   [[nodiscard]] const std::string& get_path() const { return m_path; }
 
+  /// Returns true if the buffer is a memory mapping of the file.
+  [[nodiscard]] bool is_mapped() const { return m_mapping != nullptr; }
+
   [[nodiscard]] PLineMap& get_line_map() { return m_line_map; }
   [[nodiscard]] const PLineMap& get_line_map() const { return m_line_map; }
 
 private:
-  // Populated by the lexer
+  PSourceFile(std::string p_path, void* p_mapping, size_t p_size);
+
+  void init_filename();
+
+  // Built lazily from m_buffer
   PLineMap m_line_map;
   std::string m_filename;
   std::string m_path;
-  std::string m_buffer;
+  // Owns the buffer if the file is not mapped.
+  std::string m_content;
+  void* m_mapping = nullptr;
+  size_t m_mapping_size = 0;
+  std::string_view m_buffer;
 };
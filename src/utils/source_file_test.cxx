@@ -0,0 +1,83 @@
+#include "source_file.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+class source_file_test : public ::testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    if (!m_path.empty())
+      std::filesystem::remove(m_path);
+  }
+
+  std::unique_ptr<PSourceFile> open_with_content(const std::string& p_content)
+  {
+    // One file per test, so that tests can run in parallel.
+    std::string filename = "peony_source_file_test_";
+    filename += ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    m_path = (std::filesystem::temp_directory_path() / filename).string();
+    FILE* stream = fopen(m_path.c_str(), "wb");
+    fwrite(p_content.data(), sizeof(char), p_content.size(), stream);
+    fclose(stream);
+    return PSourceFile::open(m_path);
+  }
+
+  void expect_content(const std::unique_ptr<PSourceFile>& p_file, const std::string& p_content)
+  {
+    ASSERT_NE(p_file, nullptr);
+    EXPECT_EQ(p_file->get_buffer().size(), p_content.size());
+    EXPECT_TRUE(p_file->get_buffer() == p_content);
+    // The lexer relies on the NUL terminator.
+    EXPECT_EQ(p_file->get_buffer_raw()[p_content.size()], '\0');
+  }
+
+  std::string m_path;
+};
+
+TEST_F(source_file_test, missing_file)
+{
+  EXPECT_EQ(PSourceFile::open("<missing-file>"), nullptr);
+}
+
+TEST_F(source_file_test, small_file)
+{
+  const std::string content = "fn main() -> i32 { return 0; }\n";
+  auto file = open_with_content(content);
+  expect_content(file, content);
+  EXPECT_FALSE(file->is_mapped());
+}
+
+TEST_F(source_file_test, empty_file)
+{
+  auto file = open_with_content("");
+  expect_content(file, "");
+}
+
+#ifndef _WIN32
+TEST_F(source_file_test, large_file)
+{
+  const auto page_size = (size_t)sysconf(_SC_PAGESIZE);
+  const std::string content(16 * page_size + 123, 'a');
+  auto file = open_with_content(content);
+  expect_content(file, content);
+  EXPECT_TRUE(file->is_mapped());
+}
+
+TEST_F(source_file_test, page_aligned_file)
+{
+  // No padding after the end of the file to store the NUL terminator.
+  const auto page_size = (size_t)sysconf(_SC_PAGESIZE);
+  const std::string content(16 * page_size, 'a');
+  auto file = open_with_content(content);
+  expect_content(file, content);
+  EXPECT_FALSE(file->is_mapped());
+}
+#endif
@@ -0,0 +1,177 @@
+#include "time_report.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+static std::mutex g_time_report_mutex;
+static std::map<std::string, PTimeRecord, std::less<>> g_time_report[P_TIME_GROUP_LAST];
+
+// The innermost running region of each group in the current thread.
+static thread_local PTimeRegion* g_current_region[P_TIME_GROUP_LAST] = { nullptr };
+
+static double
+get_wall_time()
+{
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+/// Returns the CPU time consumed by the current thread.
+static double
+get_cpu_time()
+{
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time);
+  auto to_seconds = [](FILETIME p_time) {
+    uint64_t ticks = (uint64_t(p_time.dwHighDateTime) << 32) | p_time.dwLowDateTime;
+    return double(ticks) * 1e-7; // FILETIME is in 100 ns units
+  };
+  return to_seconds(kernel_time) + to_seconds(user_time);
+#else
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+void
+PTimeRegion::do_start(PTimeGroup p_group, std::string_view p_name)
+{
+  m_group = p_group;
+  m_name = p_name;
+  m_running = true;
+  m_children_wall_time = 0.0;
+  m_children_cpu_time = 0.0;
+
+  m_parent = g_current_region[p_group];
+  g_current_region[p_group] = this;
+
+  m_cpu_start = get_cpu_time();
+  m_wall_start = get_wall_time();
+}
+
+void
+PTimeRegion::do_stop()
+{
+  const double wall_time = get_wall_time() - m_wall_start;
+  const double cpu_time = get_cpu_time() - m_cpu_start;
+
+  m_running = false;
+  g_current_region[m_group] = m_parent;
+  if (m_parent != nullptr) {
+    m_parent->m_children_wall_time += wall_time;
+    m_parent->m_children_cpu_time += cpu_time;
+  }
+
+  std::lock_guard lock(g_time_report_mutex);
+  auto& entries = g_time_report[m_group];
+  auto it = entries.find(m_name);
+  if (it == entries.end())
+    it = entries.emplace(std::string(m_name), PTimeRecord{}).first;
+
+  it->second.wall_time += wall_time - m_children_wall_time;
+  it->second.cpu_time += cpu_time - m_children_cpu_time;
+  it->second.count += 1;
+}
+
+PTimeRecord
+time_report_get(PTimeGroup p_group, std::string_view p_name)
+{
+  std::lock_guard lock(g_time_report_mutex);
+  auto& entries = g_time_report[p_group];
+  auto it = entries.find(p_name);
+  if (it == entries.end())
+    return {};
+  return it->second;
+}
+
+void
+time_report_clear()
+{
+  std::lock_guard lock(g_time_report_mutex);
+  for (auto& entries : g_time_report)
+    entries.clear();
+}
+
+static const char*
+get_time_group_title(PTimeGroup p_group)
+{
+  switch (p_group) {
+    case P_TIME_GROUP_PHASES:
+      return "Compiler phases";
+    case P_TIME_GROUP_LLVM_PASSES:
+      return "LLVM passes";
+    default:
+      HEDLEY_UNREACHABLE_RETURN("");
+  }
+}
+
+static void
+print_time_group(FILE* p_stream, PTimeGroup p_group)
+{
+  const auto& entries = g_time_report[p_group];
+  if (entries.empty())
+    return;
+
+  std::vector<std::pair<std::string_view, PTimeRecord>> sorted_entries(entries.begin(), entries.end());
+  std::stable_sort(sorted_entries.begin(), sorted_entries.end(), [](const auto& p_lhs, const auto& p_rhs) {
+    return p_lhs.second.wall_time > p_rhs.second.wall_time;
+  });
+
+  PTimeRecord total;
+  for (const auto& [name, record] : sorted_entries) {
+    total.wall_time += record.wall_time;
+    total.cpu_time += record.cpu_time;
+    total.count += record.count;
+  }
+
+  // Avoid divisions by zero when computing the percentages.
+  const double total_wall_time = std::max(total.wall_time, 1e-9);
+  const double total_cpu_time = std::max(total.cpu_time, 1e-9);
+
+  fprintf(p_stream, "===%s===\n", std::string(72, '-').c_str());
+  fprintf(p_stream, "  %s\n", get_time_group_title(p_group));
+  fprintf(p_stream, "===%s===\n", std::string(72, '-').c_str());
+  fprintf(p_stream, "  Total: %.4f seconds (%.4f wall clock)\n\n", total.cpu_time, total.wall_time);
+  fprintf(p_stream, "   ---CPU Time---   ---Wall Time---   --Count--  --Name--\n");
+
+  for (const auto& [name, record] : sorted_entries) {
+    fprintf(p_stream,
+            "  %7.4f (%5.1f%%)  %7.4f (%5.1f%%)  %9u  %.*s\n",
+            record.cpu_time,
+            record.cpu_time * 100.0 / total_cpu_time,
+            record.wall_time,
+            record.wall_time * 100.0 / total_wall_time,
+            record.count,
+            (int)name.size(),
+            name.data());
+  }
+
+  fprintf(p_stream,
+          "  %7.4f (100.0%%)  %7.4f (100.0%%)  %9u  Total\n\n",
+          total.cpu_time,
+          total.wall_time,
+          total.count);
+}
+
+void
+time_report_print(FILE* p_stream)
+{
+  std::lock_guard lock(g_time_report_mutex);
+  for (int i = 0; i < P_TIME_GROUP_LAST; ++i)
+    print_time_group(p_stream, (PTimeGroup)i);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../options.hxx"
+#include "time_trace.hxx"
+
+#include <cstdio>
+#include <string_view>
+
+#include <hedley.h>
+
+/// The tables of the time report (-ftime-report).
+enum PTimeGroup
+{
+  P_TIME_GROUP_PHASES,      // compiler phases (parsing, code generation, ...)
+  P_TIME_GROUP_LLVM_PASSES, // LLVM optimization passes
+
+  P_TIME_GROUP_LAST
+};
+
+/// Accumulated time of a time report entry, in seconds.
+struct PTimeRecord
+{
+  double wall_time = 0.0;
+  double cpu_time = 0.0;
+  unsigned count = 0;
+};
+
+/// Measures the time spent between its start and stop and accumulates it in
+/// the entry p_name of the time report. The region is also recorded as a span
+/// of the time trace (-ftime-trace). When both are disabled (the default),
+/// starting and stopping a region is a no-op.
+///
+/// Regions of a same group can be nested, in which case the time of the inner
+/// region is not counted in the outer one. Regions are thread-local: the time
+/// spent by other threads is never counted.
+class PTimeRegion
+{
+public:
+  PTimeRegion() = default;
+  PTimeRegion(PTimeGroup p_group, std::string_view p_name) { start(p_group, p_name); }
+  ~PTimeRegion() { stop(); }
+
+  PTimeRegion(const PTimeRegion&) = delete;
+  PTimeRegion& operator=(const PTimeRegion&) = delete;
+
+  void start(PTimeGroup p_group, std::string_view p_name)
+  {
+    if (HEDLEY_UNLIKELY(g_options.opt_time_report))
+      do_start(p_group, p_name);
+    m_trace.begin(p_name);
+  }
+
+  void stop()
+  {
+    if (HEDLEY_UNLIKELY(m_running))
+      do_stop();
+    m_trace.end();
+  }
+
+  /// Sets the detail of the span in the time trace, see PTimeTraceScope.
+  void set_trace_detail(std::string_view p_detail) { m_trace.set_detail(p_detail); }
+
+private:
+  void do_start(PTimeGroup p_group, std::string_view p_name);
+  void do_stop();
+
+  PTimeGroup m_group = P_TIME_GROUP_PHASES;
+  std::string_view m_name;
+  bool m_running = false;
+  PTimeRegion* m_parent = nullptr;
+  double m_wall_start = 0.0;
+  double m_cpu_start = 0.0;
+  // Time of the nested regions, to be subtracted.
+  double m_children_wall_time = 0.0;
+  double m_children_cpu_time = 0.0;
+  PTimeTraceScope m_trace;
+};
+
+/// Returns the accumulated time of the entry p_name (zero if the entry does
+/// not exist).
+PTimeRecord
+time_report_get(PTimeGroup p_group, std::string_view p_name);
+
+/// Removes all entries of the time report.
+void
+time_report_clear();
+
+/// Prints the time report to p_stream, one table per group with the entries
+/// sorted by decreasing wall time.
+void
+time_report_print(FILE* p_stream);
@@ -0,0 +1,70 @@
+#include "time_report.hxx"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+TEST(time_report, disabled)
+{
+  g_options.opt_time_report = false;
+  time_report_clear();
+
+  {
+    PTimeRegion region(P_TIME_GROUP_PHASES, "foo");
+  }
+
+  EXPECT_EQ(time_report_get(P_TIME_GROUP_PHASES, "foo").count, 0u);
+}
+
+TEST(time_report, accumulate)
+{
+  g_options.opt_time_report = true;
+  time_report_clear();
+
+  for (int i = 0; i < 3; ++i) {
+    PTimeRegion region(P_TIME_GROUP_PHASES, "foo");
+  }
+
+  PTimeRegion region(P_TIME_GROUP_PHASES, "bar");
+  region.stop();
+  region.stop(); // no-op, the region is already stopped
+
+  EXPECT_EQ(time_report_get(P_TIME_GROUP_PHASES, "foo").count, 3u);
+  EXPECT_EQ(time_report_get(P_TIME_GROUP_PHASES, "bar").count, 1u);
+  EXPECT_EQ(time_report_get(P_TIME_GROUP_LLVM_PASSES, "foo").count, 0u);
+
+  g_options.opt_time_report = false;
+}
+
+TEST(time_report, nested)
+{
+  g_options.opt_time_report = true;
+  time_report_clear();
+
+  auto spin = [](double p_seconds) {
+    PTimeRegion dummy; // never started
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < p_seconds) {
+    }
+  };
+
+  {
+    PTimeRegion outer(P_TIME_GROUP_PHASES, "outer");
+    {
+      PTimeRegion inner(P_TIME_GROUP_PHASES, "inner");
+      spin(0.05);
+    }
+
+    // Regions of other groups are not subtracted.
+    PTimeRegion pass(P_TIME_GROUP_LLVM_PASSES, "pass");
+  }
+
+  // The time of the inner region is not counted in the outer one.
+  auto outer = time_report_get(P_TIME_GROUP_PHASES, "outer");
+  auto inner = time_report_get(P_TIME_GROUP_PHASES, "inner");
+  EXPECT_GE(inner.wall_time, 0.05);
+  EXPECT_LT(outer.wall_time, inner.wall_time);
+  EXPECT_EQ(time_report_get(P_TIME_GROUP_LLVM_PASSES, "pass").count, 1u);
+
+  g_options.opt_time_report = false;
+}
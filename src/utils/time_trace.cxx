@@ -0,0 +1,146 @@
+#include "time_trace.hxx"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+struct PTimeTraceEvent
+{
+  std::string name;
+  std::string detail;
+  // Relative to g_time_trace_start, in nanoseconds.
+  int64_t start;
+  int64_t duration;
+};
+
+/// The events recorded by a thread. Owned by g_time_trace_threads so that
+/// they outlive the thread.
+struct PTimeTraceThread
+{
+  unsigned tid;
+  std::vector<PTimeTraceEvent> events;
+};
+
+static const auto g_time_trace_start = std::chrono::steady_clock::now();
+
+static std::mutex g_time_trace_mutex;
+static std::vector<std::unique_ptr<PTimeTraceThread>> g_time_trace_threads;
+static thread_local PTimeTraceThread* g_current_thread = nullptr;
+
+static int64_t
+get_time()
+{
+  auto elapsed = std::chrono::steady_clock::now() - g_time_trace_start;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+static PTimeTraceThread*
+get_current_thread()
+{
+  if (HEDLEY_UNLIKELY(g_current_thread == nullptr)) {
+    std::lock_guard lock(g_time_trace_mutex);
+    auto thread = std::make_unique<PTimeTraceThread>();
+    thread->tid = static_cast<unsigned>(g_time_trace_threads.size()) + 1;
+    g_current_thread = thread.get();
+    g_time_trace_threads.push_back(std::move(thread));
+  }
+
+  return g_current_thread;
+}
+
+void
+PTimeTraceScope::do_begin(std::string_view p_name)
+{
+  assert(m_event == NO_EVENT);
+  auto* thread = get_current_thread();
+  m_event = thread->events.size();
+  thread->events.push_back({ std::string(p_name), std::string(), get_time(), 0 });
+}
+
+void
+PTimeTraceScope::do_end()
+{
+  auto& event = g_current_thread->events[m_event];
+  event.duration = get_time() - event.start;
+  m_event = NO_EVENT;
+}
+
+void
+PTimeTraceScope::do_set_detail(std::string_view p_detail)
+{
+  g_current_thread->events[m_event].detail = p_detail;
+}
+
+/// Writes p_str as a JSON string literal.
+static void
+write_json_string(FILE* p_file, std::string_view p_str)
+{
+  fputc('"', p_file);
+  for (char c : p_str) {
+    switch (c) {
+      case '"':
+        fputs("\\\"", p_file);
+        break;
+      case '\\':
+        fputs("\\\\", p_file);
+        break;
+      case '\n':
+        fputs("\\n", p_file);
+        break;
+      case '\t':
+        fputs("\\t", p_file);
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          fmt::print(p_file, "\\u{:04x}", static_cast<int>(c));
+        else
+          fputc(c, p_file);
+        break;
+    }
+  }
+  fputc('"', p_file);
+}
+
+bool
+time_trace_write(const char* p_filename)
+{
+  FILE* file = fopen(p_filename, "w");
+  if (file == nullptr)
+    return false;
+
+  std::lock_guard lock(g_time_trace_mutex);
+
+  fputs("{\"traceEvents\":[\n", file);
+  fputs("{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"peony\"}}", file);
+
+  for (const auto& thread : g_time_trace_threads) {
+    fmt::print(file,
+               ",\n{{\"ph\":\"M\",\"pid\":1,\"tid\":{0},\"name\":\"thread_name\",\"args\":{{\"name\":\"thread {0}\"}}}}",
+               thread->tid);
+
+    for (const auto& event : thread->events) {
+      fmt::print(file,
+                 ",\n{{\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"name\":",
+                 thread->tid,
+                 event.start / 1000.0,
+                 event.duration / 1000.0);
+      write_json_string(file, event.name);
+      if (!event.detail.empty()) {
+        fputs(",\"args\":{\"detail\":", file);
+        write_json_string(file, event.detail);
+        fputc('}', file);
+      }
+      fputc('}', file);
+    }
+  }
+
+  fputs("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+  fclose(file);
+  return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../options.hxx"
+
+#include <cstddef>
+#include <string_view>
+
+#include <hedley.h>
+
+/// Returns true if the time trace (-ftime-trace) is enabled.
+inline bool
+time_trace_enabled()
+{
+  return g_options.opt_time_trace != nullptr;
+}
+
+/// Records a span (a "complete event") in the time trace, starting at begin()
+/// and ending at end(). When the time trace is disabled (the default), this
+/// is a no-op.
+///
+/// Each thread records its own spans. They are nested by the trace viewers
+/// according to their times.
+class PTimeTraceScope
+{
+public:
+  PTimeTraceScope() = default;
+  explicit PTimeTraceScope(std::string_view p_name) { begin(p_name); }
+  ~PTimeTraceScope() { end(); }
+
+  PTimeTraceScope(const PTimeTraceScope&) = delete;
+  PTimeTraceScope& operator=(const PTimeTraceScope&) = delete;
+
+  void begin(std::string_view p_name)
+  {
+    if (HEDLEY_UNLIKELY(time_trace_enabled()))
+      do_begin(p_name);
+  }
+
+  void end()
+  {
+    if (HEDLEY_UNLIKELY(m_event != NO_EVENT))
+      do_end();
+  }
+
+  /// Sets the detail of the span (for example, the name of the function being
+  /// processed). Can be called at any time before end().
+  void set_detail(std::string_view p_detail)
+  {
+    if (HEDLEY_UNLIKELY(m_event != NO_EVENT))
+      do_set_detail(p_detail);
+  }
+
+private:
+  void do_begin(std::string_view p_name);
+  void do_end();
+  void do_set_detail(std::string_view p_detail);
+
+  static constexpr size_t NO_EVENT = static_cast<size_t>(-1);
+  // Index of the event in the buffer of the current thread.
+  size_t m_event = NO_EVENT;
+};
+
+/// Writes all the recorded spans (from all threads) to p_filename in the
+/// Chrome trace event format, which can be loaded in chrome://tracing or
+/// Perfetto. Returns false if the file can not be opened.
+bool
+time_trace_write(const char* p_filename);
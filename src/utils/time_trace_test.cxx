@@ -0,0 +1,38 @@
+#include "time_trace.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+TEST(time_trace, write)
+{
+  g_options.opt_time_trace = "time_trace_test.json";
+
+  {
+    PTimeTraceScope outer("outer");
+    PTimeTraceScope inner("inner \"quoted\"");
+    inner.set_detail("some_function");
+  }
+
+  ASSERT_TRUE(time_trace_write(g_options.opt_time_trace));
+  g_options.opt_time_trace = nullptr;
+
+  // Not recorded, the time trace is disabled.
+  {
+    PTimeTraceScope scope("disabled");
+  }
+
+  std::ifstream file("time_trace_test.json");
+  std::stringstream content;
+  content << file.rdbuf();
+  file.close();
+  remove("time_trace_test.json");
+
+  const std::string json = content.str();
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_NE(json.find("\"name\":\"outer\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"inner \\\"quoted\\\"\",\"args\":{\"detail\":\"some_function\"}"), std::string::npos);
+  EXPECT_EQ(json.find("disabled"), std::string::npos);
+}
@@ -0,0 +1,37 @@
+cmake_policy(SET CMP0012 NEW)
+
+file(REMOVE_RECURSE ${CACHE_DIR})
+
+# Compiles INPUT_FILE with the given flags to OUTPUT, using the cache.
+function(compile OUTPUT)
+    execute_process(COMMAND ${PEONY_EXE} -flto -fcache-dir=${CACHE_DIR} ${ARGN} ${INPUT_FILE} -o ${OUTPUT}
+            RESULT_VARIABLE CMD_RESULT)
+    if (CMD_RESULT)
+        message(FATAL_ERROR "Failed to compile ${INPUT_FILE} to ${OUTPUT}")
+    endif ()
+endfunction()
+
+# Checks that OUTPUT is a native object file and not LLVM bitcode.
+function(check_native_object OUTPUT)
+    file(READ ${OUTPUT} MAGIC LIMIT 4 HEX)
+    if (MAGIC STREQUAL "4243c0de")
+        message(FATAL_ERROR "${OUTPUT} is LLVM bitcode, expected a native object file")
+    endif ()
+endfunction()
+
+# Checks that the executable OUTPUT runs successfully.
+function(check_executable OUTPUT)
+    execute_process(COMMAND ${OUTPUT} RESULT_VARIABLE CMD_RESULT)
+    if (CMD_RESULT)
+        message(FATAL_ERROR "${OUTPUT} exited with code ${CMD_RESULT}")
+    endif ()
+endfunction()
+
+# Each build is done twice to also hit the cache entries stored by the first.
+foreach (ITERATION 1 2)
+    compile(${OUTPUT_PREFIX}.o -c)
+    check_native_object(${OUTPUT_PREFIX}.o)
+
+    compile(${OUTPUT_PREFIX}.exe)
+    check_executable(${OUTPUT_PREFIX}.exe)
+endforeach ()
@@ -0,0 +1,30 @@
+cmake_policy(SET CMP0012 NEW)
+
+# A clean file long enough to be still parsed by the other thread when the
+# file with errors stops the compilation.
+string(REPEAT "    assert(add(5, 10) == 15);\n" 20000 BODY)
+set(INPUT_FILE ${CMAKE_CURRENT_BINARY_DIR}/stopped_compilation.peony)
+file(WRITE ${INPUT_FILE} "fn add(a: i32, b: i32) -> i32 {\n    return a + b;\n}\n\nfn main() -> i32 {\n${BODY}    return 0;\n}\n")
+set(OUTPUT_FILE stopped_compilation.o)
+
+# The race is retried a few times.
+foreach (ITERATION RANGE 1 3)
+    file(REMOVE_RECURSE ${CACHE_DIR})
+    execute_process(COMMAND ${PEONY_EXE} -c -j2 -fmax-errors=1 -fcache-dir=${CACHE_DIR} ${INPUT_FILE} ${ERROR_INPUT_FILE}
+            RESULT_VARIABLE CMD_RESULT ERROR_QUIET)
+    if (NOT CMD_RESULT)
+        message(FATAL_ERROR "The compilation of ${ERROR_INPUT_FILE} was expected to fail")
+    endif ()
+
+    # Must not hit an entry stored by the stopped compilation.
+    file(REMOVE ${OUTPUT_FILE})
+    execute_process(COMMAND ${PEONY_EXE} -c -fcache-dir=${CACHE_DIR} ${INPUT_FILE} RESULT_VARIABLE CMD_RESULT)
+    if (CMD_RESULT)
+        message(FATAL_ERROR "Failed to compile ${INPUT_FILE}")
+    endif ()
+
+    file(SIZE ${OUTPUT_FILE} OUTPUT_SIZE)
+    if (OUTPUT_SIZE EQUAL 0)
+        message(FATAL_ERROR "${OUTPUT_FILE} is empty")
+    endif ()
+endforeach ()
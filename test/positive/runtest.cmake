@@ -1,9 +1,15 @@
 cmake_policy(SET CMP0012 NEW)
 
-execute_process(COMMAND ${PEONY_EXE} ${INPUT_FILE} -o ${OUTPUT_FILE} RESULT_VARIABLE CMD_RESULT)
-message(STATUS "Compiler exited with code ${CMD_RESULT}")
-if (CMD_RESULT)
-    message(FATAL_ERROR "Failed to compile ${INPUT_FILE}")
+if (USE_JIT)
+    # The compiler itself runs the program and returns its exit code.
+    execute_process(COMMAND ${PEONY_EXE} --run ${INPUT_FILE} RESULT_VARIABLE CMD_RESULT)
+    message(STATUS "Program run by the JIT exited with code ${CMD_RESULT}")
+else ()
+    execute_process(COMMAND ${PEONY_EXE} ${INPUT_FILE} -o ${OUTPUT_FILE} RESULT_VARIABLE CMD_RESULT)
+    message(STATUS "Compiler exited with code ${CMD_RESULT}")
+    if (CMD_RESULT)
+        message(FATAL_ERROR "Failed to compile ${INPUT_FILE}")
+    endif ()
 endif ()
 
 if (${EXPECT_FAIL})
@@ -12,15 +18,17 @@ else ()
     message(STATUS "Compiled file expected to pass")
 endif ()
 
-execute_process(COMMAND ${OUTPUT_FILE} RESULT_VARIABLE CMD_RESULT)
-message(STATUS "Compiled file exited with code ${CMD_RESULT}")
+if (NOT USE_JIT)
+    execute_process(COMMAND ${OUTPUT_FILE} RESULT_VARIABLE CMD_RESULT)
+    message(STATUS "Compiled file exited with code ${CMD_RESULT}")
+endif ()
 
 if (CMD_RESULT)
     if (NOT ${EXPECT_FAIL})
-        message(FATAL_ERROR "Test failed ${OUTPUT_FILE}")
+        message(FATAL_ERROR "Test failed ${INPUT_FILE}")
     endif ()
 else ()
     if (${EXPECT_FAIL})
-        message(FATAL_ERROR "Test failed ${OUTPUT_FILE}")
+        message(FATAL_ERROR "Test failed ${INPUT_FILE}")
     endif ()
 endif ()